@@ -166,6 +166,18 @@ standard names. */
 
 /* =============== HST Configuration ===================== */
 
+/* Set to 0 to build plain FreeRTOS applications, without the HST. */
+#ifndef configUSE_HST
+	#define configUSE_HST 1
+#endif
+
+/* Set to 1 to map the trace macros to the benchmark probes. */
+#ifndef configHST_BENCHMARK
+	#define configHST_BENCHMARK 0
+#endif
+
+#if ( configUSE_HST == 1 )
+
 /* Prototypes for trace blocking and suspended tasks. */
 void vSchedulerTaskDelay( void );
 void vSchedulerTaskReady( void* xTask );
@@ -186,3 +198,124 @@ void vSchedulerTaskSuspend( void* xTask );
 #define INCLUDE_eTaskGetState           1
 #define INCLUDE_pcTaskGetTaskName		1
 #define INCLUDE_xTaskGetCurrentTaskHandle 1
+
+/* Scheduling overheads charged by the response time analysis, in CPU cycles
+ * (0: the HST is free). vWcrtSetOverheads() replaces them at run time, e.g.
+ * with the maxima measured by the benchmark (examples/bench). */
+#ifndef configHST_TICK_OVERHEAD_CYCLES
+	#define configHST_TICK_OVERHEAD_CYCLES        0
+#endif
+#ifndef configHST_DISPATCH_OVERHEAD_CYCLES
+	#define configHST_DISPATCH_OVERHEAD_CYCLES    0
+#endif
+#ifndef configHST_PREEMPTION_OVERHEAD_CYCLES
+	#define configHST_PREEMPTION_OVERHEAD_CYCLES  0
+#endif
+
+/* Set to 1 so vSchedulerInit() replaces the priorities of the periodic tasks
+ * with Audsley's optimal assignment (xWcrtAssignPriorities()), when one
+ * exists. Fixed priority policies only. */
+#ifndef configHST_OPTIMAL_PRIORITIES
+	#define configHST_OPTIMAL_PRIORITIES          0
+#endif
+
+/* Set to 1 so vSchedulerInit() runs the sensitivity analysis after the
+ * schedulability test (xSensitivityAnalyse()), setting the xWcetMax of each
+ * periodic task. */
+#ifndef configHST_SENSITIVITY
+	#define configHST_SENSITIVITY                 0
+#endif
+
+/* Set to 1 so the HST measures the execution times of the periodic jobs
+ * (adaptive.h): maximum and configHST_ADAPTIVE_QUANTILE percent quantile of
+ * the last configHST_ADAPTIVE_WINDOW jobs of each task, updated every
+ * configHST_ADAPTIVE_PERIOD ticks. With configHST_ADAPTIVE_REANALYSIS set to
+ * 1, the quantile plus configHST_ADAPTIVE_MARGIN percent replaces the wcet in
+ * the analysis and the slack, back to the declared wcets at the first job
+ * that runs past it. */
+#ifndef configHST_ADAPTIVE_WCET
+	#define configHST_ADAPTIVE_WCET               0
+#endif
+#ifndef configHST_ADAPTIVE_REANALYSIS
+	#define configHST_ADAPTIVE_REANALYSIS         0
+#endif
+#ifndef configHST_ADAPTIVE_WINDOW
+	#define configHST_ADAPTIVE_WINDOW             32
+#endif
+#ifndef configHST_ADAPTIVE_QUANTILE
+	#define configHST_ADAPTIVE_QUANTILE           95
+#endif
+#ifndef configHST_ADAPTIVE_MARGIN
+	#define configHST_ADAPTIVE_MARGIN             20
+#endif
+#ifndef configHST_ADAPTIVE_PERIOD
+	#define configHST_ADAPTIVE_PERIOD             1000
+#endif
+
+/* Header generated by the task set compiler (tools/hstc). When defined, e.g.
+ * as "hst_tables.h", vSchedulerInit() takes the response times, wcet
+ * headroom and slacks from it instead of analysing the task set at boot. */
+/* #define configHST_TABLES_HEADER               "hst_tables.h" */
+
+#endif
+
+/* =============== HST Benchmark ===================== */
+
+#if ( configHST_BENCHMARK == 1 )
+
+#ifndef BENCH_TASKS
+	#define BENCH_TASKS 4
+#endif
+
+#ifndef configBENCH_HEAP_SIZE
+	#define configBENCH_HEAP_SIZE ( 16 * 1024 )
+#endif
+
+/* Prototypes for the benchmark probes (examples/bench). */
+void vBenchTaskReady( void* pxTCB );
+void vBenchTaskSwitchedOut( void );
+void vBenchTaskSwitchedIn( void* pxTCB );
+void vBenchTickEnter( void );
+void vBenchTickHookEnter( void );
+void vBenchTickHookExit( void );
+void vBenchSchedulerEnter( void );
+void vBenchSchedulerExit( void );
+void vBenchSlackEnter( void );
+void vBenchSlackExit( void );
+
+/* Probes mapping. */
+#define traceTASK_INCREMENT_TICK(xTickCount)        vBenchTickEnter();
+#define traceTASK_SWITCHED_OUT()                    vBenchTaskSwitchedOut();
+#define traceTASK_SWITCHED_IN()                     vBenchTaskSwitchedIn( pxCurrentTCB );
+/* FreeRTOS v8 has a single ready trace macro, shared with the HST. */
+#undef traceMOVED_TASK_TO_READY_STATE
+#if ( configUSE_HST == 1 )
+	#define traceMOVED_TASK_TO_READY_STATE(xTask)   vBenchTaskReady( xTask ); vSchedulerTaskReady( xTask );
+#else
+	#define traceMOVED_TASK_TO_READY_STATE(xTask)   vBenchTaskReady( xTask );
+#endif
+#define traceHST_TICK_HOOK_ENTER()                  vBenchTickHookEnter();
+#define traceHST_TICK_HOOK_EXIT()                   vBenchTickHookExit();
+#define traceHST_SCHEDULER_ENTER()                  vBenchSchedulerEnter();
+#define traceHST_SCHEDULER_EXIT()                   vBenchSchedulerExit();
+#define traceHST_SLACK_ENTER()                      vBenchSlackEnter();
+#define traceHST_SLACK_EXIT()                       vBenchSlackExit();
+
+/* The same kernel settings on every run and on both FreeRTOS versions: one
+FreeRTOS priority per benchmark task for the native runs, task numbers for the
+probes, a fixed heap and the same optional kernel features. */
+#undef configMAX_PRIORITIES
+#define configMAX_PRIORITIES                        ( BENCH_TASKS + 3 )
+#undef configUSE_TRACE_FACILITY
+#define configUSE_TRACE_FACILITY                    1
+#undef configTOTAL_HEAP_SIZE
+#define configTOTAL_HEAP_SIZE                       ( ( size_t ) ( configBENCH_HEAP_SIZE ) )
+#undef configUSE_MUTEXES
+#define configUSE_MUTEXES                           1
+#undef configUSE_RECURSIVE_MUTEXES
+#define configUSE_RECURSIVE_MUTEXES                 1
+#undef configUSE_COUNTING_SEMAPHORES
+#define configUSE_COUNTING_SEMAPHORES               1
+#define INCLUDE_uxTaskGetStackHighWaterMark         1
+
+#endif
@@ -0,0 +1,315 @@
+#include "bench.h"
+#include "task.h"
+#include "utils.h"
+
+#if ( configUSE_HST == 1 )
+#include "scheduler.h"
+#include "scheduler_logic.h"
+#include "taskset.h"
+#include "wcrt.h"
+#if ( USE_QPA == 1 )
+#include "qpa.h"
+#endif
+#endif
+
+/* Task numbers 1..BENCH_TASKS identify the benchmark tasks, 0 any other. */
+#define benchMAX_TASK_NUMBER  ( BENCH_TASKS )
+
+static void prvBenchRecord( BenchSample_t *pxSample, uint32_t ulCycles );
+
+/* Measurements. */
+static BenchStats_t xStats;
+
+/* pdTRUE while a measurement window is open. */
+static volatile BaseType_t xRunning = pdFALSE;
+
+/* Tick count at the start of the window. */
+static TickType_t xWindowStart = 0;
+
+/* Section start timestamps. */
+static uint32_t ulTickStart = 0;
+static uint32_t ulTickHookStart = 0;
+static uint32_t ulSchedulerStart = 0;
+static uint32_t ulSlackStart = 0;
+static uint32_t ulSwitchedOut = 0;
+
+/* pdTRUE between the tick increment and the end of the tick hook. */
+static BaseType_t xInTick = pdFALSE;
+
+/* Pending releases: timestamp of the release of the current job of each task,
+ * until it is switched in. */
+static uint32_t ulReleaseTime[ benchMAX_TASK_NUMBER + 1 ];
+static BaseType_t xReleasePending[ benchMAX_TASK_NUMBER + 1 ];
+
+/* Task running before the last switch. */
+static void *pxLastTCB = NULL;
+
+void vBenchStart( void )
+{
+	UBaseType_t uxI;
+
+	taskENTER_CRITICAL();
+	{
+		BenchSample_t xEmpty = { 0, 0, 0 };
+
+		xStats.xTicks = 0;
+		xStats.xScheduler = xEmpty;
+		xStats.xTickIsr = xEmpty;
+		xStats.xTickHook = xEmpty;
+		xStats.xLatency = xEmpty;
+		xStats.xDispatch = xEmpty;
+		xStats.xSlack = xEmpty;
+		xStats.xAperiodic = xEmpty;
+		xStats.ulJobs = 0;
+		xStats.ulContextSwitches = 0;
+		xStats.ulDeadlineMisses = 0;
+		xStats.ulOverruns = 0;
+
+		for( uxI = 0; uxI <= benchMAX_TASK_NUMBER; uxI++ )
+		{
+			xReleasePending[ uxI ] = pdFALSE;
+		}
+
+		xInTick = pdFALSE;
+		xWindowStart = xTaskGetTickCount();
+		xRunning = pdTRUE;
+	}
+	taskEXIT_CRITICAL();
+}
+
+void vBenchStop( void )
+{
+	taskENTER_CRITICAL();
+	{
+		xRunning = pdFALSE;
+		xStats.xTicks = xTaskGetTickCount() - xWindowStart;
+	}
+	taskEXIT_CRITICAL();
+}
+
+const BenchStats_t * pxBenchGetStats( void )
+{
+	return &xStats;
+}
+
+BaseType_t xBenchSchedulableWithOverheads( void )
+{
+#if ( configUSE_HST == 1 )
+	/* A job is released and completed through the HST: each activation
+	 * switches from the running task to the HST and back to a task. */
+	const uint32_t ulActivation = xStats.xScheduler.ulMax + ( 2 * xStats.xDispatch.ulMax );
+	static TickType_t xSetWcrt[ BENCH_TASKS ];
+	static TickType_t xTaskWcrt[ BENCH_TASKS ];
+	BaseType_t xSchedulable;
+	UBaseType_t uxI;
+
+	configASSERT( xHstTaskSet.uxCount <= BENCH_TASKS );
+
+	/* dp and ss read the response times, and the slack methods the
+	 * overheads, while the tasks run: the analysis runs with the HST
+	 * suspended, and both are restored before it resumes. */
+	vTaskSuspendAll();
+
+	for( uxI = 0; uxI < xHstTaskSet.uxCount; uxI++ )
+	{
+		xSetWcrt[ uxI ] = xHstTaskSet.pxWcrt[ uxI ];
+		xTaskWcrt[ uxI ] = xHstTaskSet.pxTask[ uxI ]->xWcrt;
+	}
+
+	vWcrtSetOverheads( xStats.xTickIsr.ulMax, 2 * ulActivation, xStats.xDispatch.ulMax );
+
+#if ( USE_QPA == 1 )
+	xSchedulable = xQpaCalculateTasksSchedulability();
+#else
+	xSchedulable = xWcrtCalculateTasksWcrt();
+#endif
+
+	vWcrtSetOverheads( configHST_TICK_OVERHEAD_CYCLES, configHST_DISPATCH_OVERHEAD_CYCLES, configHST_PREEMPTION_OVERHEAD_CYCLES );
+
+	for( uxI = 0; uxI < xHstTaskSet.uxCount; uxI++ )
+	{
+		xHstTaskSet.pxWcrt[ uxI ] = xSetWcrt[ uxI ];
+		xHstTaskSet.pxTask[ uxI ]->xWcrt = xTaskWcrt[ uxI ];
+	}
+
+	( void ) xTaskResumeAll();
+
+	return xSchedulable;
+#else
+	return pdFALSE;
+#endif
+}
+
+void vBenchJobEnd( void )
+{
+	if( xRunning == pdTRUE )
+	{
+		xStats.ulJobs++;
+	}
+}
+
+void vBenchAperiodic( TickType_t xResponse )
+{
+	if( xRunning == pdTRUE )
+	{
+		prvBenchRecord( &( xStats.xAperiodic ), ( uint32_t ) xResponse );
+	}
+}
+
+void vBenchDeadlineMiss( void )
+{
+	if( xRunning == pdTRUE )
+	{
+		xStats.ulDeadlineMisses++;
+	}
+}
+
+void vBenchOverrun( void )
+{
+	if( xRunning == pdTRUE )
+	{
+		xStats.ulOverruns++;
+	}
+}
+
+/**
+ * A task moved to the FreeRTOS ready list. Only new jobs are releases: under
+ * the HST a task is also made ready when the HST resumes it.
+ */
+void vBenchTaskReady( void* pxTCB )
+{
+	UBaseType_t uxNumber;
+
+	if( xRunning == pdFALSE )
+	{
+		return;
+	}
+
+	uxNumber = uxTaskGetTaskNumber( ( TaskHandle_t ) pxTCB );
+
+	if( ( uxNumber == 0 ) || ( uxNumber > benchMAX_TASK_NUMBER ) || ( xReleasePending[ uxNumber ] == pdTRUE ) )
+	{
+		return;
+	}
+
+#if ( configUSE_HST == 1 )
+	HstTCB_t *pxTaskInfo = ( HstTCB_t * ) pvTaskGetThreadLocalStoragePointer( ( TaskHandle_t ) pxTCB, 0 );
+
+	if( ( pxTaskInfo == NULL ) || ( pxTaskInfo->xState != HST_FINISHED ) )
+	{
+		return;
+	}
+#endif
+
+	ulReleaseTime[ uxNumber ] = ulUtilsCycleCount();
+	xReleasePending[ uxNumber ] = pdTRUE;
+}
+
+void vBenchTaskSwitchedOut( void )
+{
+	ulSwitchedOut = ulUtilsCycleCount();
+}
+
+void vBenchTaskSwitchedIn( void* pxTCB )
+{
+	const uint32_t ulNow = ulUtilsCycleCount();
+	UBaseType_t uxNumber;
+
+	if( pxTCB == pxLastTCB )
+	{
+		return;
+	}
+
+	pxLastTCB = pxTCB;
+
+	if( xRunning == pdFALSE )
+	{
+		return;
+	}
+
+	xStats.ulContextSwitches++;
+	prvBenchRecord( &( xStats.xDispatch ), ulNow - ulSwitchedOut );
+
+	uxNumber = uxTaskGetTaskNumber( ( TaskHandle_t ) pxTCB );
+
+	if( ( uxNumber != 0 ) && ( uxNumber <= benchMAX_TASK_NUMBER ) && ( xReleasePending[ uxNumber ] == pdTRUE ) )
+	{
+		prvBenchRecord( &( xStats.xLatency ), ulNow - ulReleaseTime[ uxNumber ] );
+		xReleasePending[ uxNumber ] = pdFALSE;
+	}
+}
+
+void vBenchTickEnter( void )
+{
+	ulTickStart = ulUtilsCycleCount();
+	xInTick = pdTRUE;
+}
+
+void vBenchTickHookEnter( void )
+{
+	ulTickHookStart = ulUtilsCycleCount();
+}
+
+void vBenchTickHookExit( void )
+{
+	const uint32_t ulNow = ulUtilsCycleCount();
+
+	if( xRunning == pdTRUE )
+	{
+		prvBenchRecord( &( xStats.xTickHook ), ulNow - ulTickHookStart );
+
+		/* The hook is also called for ticks pended while the scheduler was
+		 * suspended, outside the tick increment. */
+		if( xInTick == pdTRUE )
+		{
+			prvBenchRecord( &( xStats.xTickIsr ), ulNow - ulTickStart );
+		}
+	}
+
+	xInTick = pdFALSE;
+}
+
+void vBenchSchedulerEnter( void )
+{
+	ulSchedulerStart = ulUtilsCycleCount();
+}
+
+/**
+ * The interval includes the interrupts served while the HST runs, as they
+ * also delay the application tasks.
+ */
+void vBenchSchedulerExit( void )
+{
+	if( xRunning == pdTRUE )
+	{
+		prvBenchRecord( &( xStats.xScheduler ), ulUtilsCycleCount() - ulSchedulerStart );
+	}
+}
+
+void vBenchSlackEnter( void )
+{
+	ulSlackStart = ulUtilsCycleCount();
+}
+
+/**
+ * Charging the elapsed ticks, the computations at the job ends and the steps
+ * of the computations in progress: the slack share of the HST activation.
+ */
+void vBenchSlackExit( void )
+{
+	if( xRunning == pdTRUE )
+	{
+		prvBenchRecord( &( xStats.xSlack ), ulUtilsCycleCount() - ulSlackStart );
+	}
+}
+
+static void prvBenchRecord( BenchSample_t *pxSample, uint32_t ulCycles )
+{
+	pxSample->ullSum = pxSample->ullSum + ulCycles;
+	pxSample->ulCount = pxSample->ulCount + 1;
+
+	if( ulCycles > pxSample->ulMax )
+	{
+		pxSample->ulMax = ulCycles;
+	}
+}
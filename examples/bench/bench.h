@@ -0,0 +1,99 @@
+#include "FreeRTOS.h"
+
+/**
+ * Accumulated cost of a measured section, in CPU cycles.
+ */
+typedef struct
+{
+	uint64_t ullSum;   /* Total cycles. */
+	uint32_t ulMax;    /* Longest sample. */
+	uint32_t ulCount;  /* Number of samples. */
+} BenchSample_t;
+
+/**
+ * Benchmark measurements for one window.
+ */
+typedef struct
+{
+	TickType_t xTicks;                /* Window length, in ticks. */
+	BenchSample_t xScheduler;         /* HST task, one sample per activation. */
+	BenchSample_t xTickIsr;           /* Tick increment up to the tick hook exit. */
+	BenchSample_t xTickHook;          /* Tick hook (HST bookkeeping). */
+	BenchSample_t xLatency;           /* Release to first instruction of a job. */
+	BenchSample_t xDispatch;          /* Kernel task selection, switched out to switched in. */
+	BenchSample_t xSlack;             /* Slack computation in the HST (ss), one sample per activation. */
+	BenchSample_t xAperiodic;         /* Aperiodic response times, in ticks. */
+	uint32_t ulJobs;                  /* Completed periodic jobs. */
+	uint32_t ulContextSwitches;       /* Switches between different tasks. */
+	uint32_t ulDeadlineMisses;        /* Jobs that finished after their deadline. */
+	uint32_t ulOverruns;              /* Jobs that executed beyond their wcet. */
+} BenchStats_t;
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * Reset the measurements and start a measurement window.
+ */
+void vBenchStart( void );
+
+/**
+ * Close the measurement window.
+ */
+void vBenchStop( void );
+
+/**
+ *
+ * @return the measurements of the last window.
+ */
+const BenchStats_t * pxBenchGetStats( void );
+
+/**
+ * Analyses the task set charging the overheads measured in the last window
+ * (vWcrtSetOverheads()): the tick interrupt maximum per tick, two HST
+ * activations and four task switches per job, and one more task switch per
+ * preemption. The response times and overheads the HST schedules with are
+ * left unchanged.
+ *
+ * @return the result of the policy test (xWcrtCalculateTasksWcrt() or
+ * xQpaCalculateTasksSchedulability()).
+ */
+BaseType_t xBenchSchedulableWithOverheads( void );
+
+/**
+ * Account a completed periodic job.
+ */
+void vBenchJobEnd( void );
+
+/**
+ * Account the response time of an aperiodic job, in ticks.
+ */
+void vBenchAperiodic( TickType_t xResponse );
+
+/**
+ * Account a missed deadline.
+ */
+void vBenchDeadlineMiss( void );
+
+/**
+ * Account a wcet overrun.
+ */
+void vBenchOverrun( void );
+
+/* --- Probes, called from the kernel trace macros (see FreeRTOSConfig.h) --- */
+
+void vBenchTaskReady( void* pxTCB );
+void vBenchTaskSwitchedOut( void );
+void vBenchTaskSwitchedIn( void* pxTCB );
+void vBenchTickEnter( void );
+void vBenchTickHookEnter( void );
+void vBenchTickHookExit( void );
+void vBenchSchedulerEnter( void );
+void vBenchSchedulerExit( void );
+void vBenchSlackEnter( void );
+void vBenchSlackExit( void );
+
+#if defined (__cplusplus)
+}
+#endif
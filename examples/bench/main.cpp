@@ -0,0 +1,411 @@
+#include "FreeRTOS.h"
+#include "task.h"
+#include "mbed.h"
+#include "utils.h"
+#include "bench.h"
+
+#if ( configUSE_HST == 1 )
+#include "scheduler.h"
+#include "scheduler_logic.h"
+#include "adaptive.h"
+#if ( USE_SLACK_STEALING == 1 )
+#include "slack.h"
+#endif
+#endif
+
+#include <stdio.h>
+
+#ifndef BENCH_TICKS
+	#define BENCH_TICKS 10000
+#endif
+
+#ifndef BENCH_BOARD
+	#define BENCH_BOARD "unknown"
+#endif
+
+#ifndef BENCH_POLICY
+	#define BENCH_POLICY "unknown"
+#endif
+
+/* Ticks executed before the measurement window, so the first releases of
+ * the task set do not distort the results. */
+#define BENCH_WARMUP_TICKS  1000
+
+/* Task set generator: T_i = BENCH_PERIOD_BASE + i * BENCH_PERIOD_STEP, with
+ * equal utilization per task and BENCH_UTILIZATION percent in total. */
+#define BENCH_PERIOD_BASE   200
+#define BENCH_PERIOD_STEP   50
+#define BENCH_UTILIZATION   50
+
+/* Aperiodic load under slack stealing: jobs of BENCH_APERIODIC_WCET ticks,
+ * with uniformly distributed interarrival times and BENCH_APERIODIC_LOAD
+ * percent of the CPU on average. */
+#define BENCH_APERIODIC_WCET    5
+#define BENCH_APERIODIC_LOAD    10
+#define BENCH_APERIODIC_SEED    0x5eed
+
+#if ( configUSE_HST == 1 )
+	#define BENCH_REPORTER_PRIORITY TASK_SCHEDULER_PRIORITY
+#else
+	#define BENCH_REPORTER_PRIORITY ( configMAX_PRIORITIES - 1 )
+#endif
+
+/* The extern "C" is required to avoid name mangling between C and C++ code. */
+extern "C"
+{
+// FreeRTOS callback/hook functions
+void vApplicationMallocFailedHook( void );
+void vApplicationStackOverflowHook( TaskHandle_t pxTask, char *pcTaskName );
+
+#if ( configUSE_HST == 1 )
+// HST callback/hook functions
+void vSchedulerNegativeSlackHook( TickType_t xTickCount, BaseType_t xSlack );
+void vSchedulerDeadlineMissHook( HstTCB_t * xTask, const TickType_t xTickCount );
+void vSchedulerWcetOverrunHook( HstTCB_t * xTask, const TickType_t xTickCount );
+void vSchedulerStartHook( void );
+#else
+void vApplicationTickHook( void );
+#endif
+}
+
+/**
+ * Benchmark task parameters.
+ */
+typedef struct
+{
+	TickType_t xPeriod;
+	TickType_t xWcet;
+	TaskHandle_t xHandle;
+	UtilsWorkload_t xWorkload;
+	UBaseType_t uxLastMissRelease;    /* Release already accounted as a miss. */
+	UBaseType_t uxLastOverrunRelease; /* Release already accounted as an overrun. */
+} BenchTask_t;
+
+static void task_body( void* params );
+static void reporter_body( void* params );
+#if ( USE_SLACK_STEALING == 1 ) || ( USE_EDL_SLACK == 1 ) || ( USE_RECLAIMING == 1 )
+static void aperiodic_body( void* params );
+#endif
+
+#if ( USE_SLACK_STEALING == 1 )
+static const char * const pcSlackMethods[] = { "exact", "approx", "bounded", "fixed", "table" };
+#endif
+
+/* Create a Serial port, connected to the USBTX/USBRX pins; they represent the
+ * pins that route to the interface USB Serial port so you can communicate with
+ * a host PC. */
+static Serial pc( USBTX, USBRX );
+
+static BenchTask_t xTasks[ BENCH_TASKS ];
+
+int main() {
+	/* Set the baud rate of the serial port. */
+	pc.baud( 9600 );
+
+	/* Measure the workload kernels, so the jobs match the requested ticks. */
+	vUtilsCalibrate();
+
+#if ( configUSE_HST == 1 )
+	vSchedulerSetup();
+#endif
+
+	for( UBaseType_t uxI = 0; uxI < BENCH_TASKS; uxI++ )
+	{
+		char pcName[ configMAX_TASK_NAME_LEN ];
+		TaskHandle_t xHandle = NULL;
+
+		BenchTask_t *pxTask = &( xTasks[ uxI ] );
+
+		pxTask->xPeriod = BENCH_PERIOD_BASE + uxI * BENCH_PERIOD_STEP;
+		pxTask->xWcet = ( pxTask->xPeriod * BENCH_UTILIZATION ) / ( 100 * BENCH_TASKS );
+
+		if( pxTask->xWcet == 0 )
+		{
+			pxTask->xWcet = 1;
+		}
+
+		/* Jobs execute between half and three quarters of their wcet. */
+		pxTask->xWorkload.xKernel = UTILS_KERNEL_SPIN;
+		pxTask->xWorkload.xDist = UTILS_DIST_UNIFORM;
+		pxTask->xWorkload.xMin = pxTask->xWcet / 2;
+		pxTask->xWorkload.xMax = ( pxTask->xWcet * 3 ) / 4;
+		pxTask->xWorkload.uxHighPercent = 0;
+		pxTask->uxLastMissRelease = 0;
+		pxTask->uxLastOverrunRelease = 0;
+
+		snprintf( pcName, sizeof( pcName ), "B%02u", ( unsigned ) ( uxI + 1 ) );
+
+#if ( configUSE_HST == 1 )
+		/* Rate monotonic priorities, shorter periods first. */
+		HstTCB_t *pxHst = NULL;
+		if( xSchedulerTaskCreate( task_body, pcName, 256, NULL, uxI, &pxHst, pxTask->xPeriod, pxTask->xPeriod, pxTask->xWcet ) == pdPASS )
+		{
+			xHandle = pxHst->xHandle;
+		}
+#else
+		xTaskCreate( task_body, pcName, 256, pxTask, ( configMAX_PRIORITIES - 2 ) - uxI, &xHandle );
+#endif
+
+		/* Task numbers map the kernel probes to the benchmark tasks. */
+		if( xHandle != NULL )
+		{
+			vTaskSetTaskNumber( xHandle, uxI + 1 );
+		}
+
+		pxTask->xHandle = xHandle;
+	}
+
+#if ( USE_SLACK_STEALING == 1 ) || ( USE_EDL_SLACK == 1 ) || ( USE_RECLAIMING == 1 )
+	/* Aperiodic jobs served with the slack of the periodic tasks. */
+	xSchedulerAperiodicTaskCreate( aperiodic_body, "BAP", 256, NULL, NULL );
+#endif
+
+	xTaskCreate( reporter_body, "BRP", 256, NULL, BENCH_REPORTER_PRIORITY, NULL );
+
+#if ( configUSE_HST == 1 )
+	/* Create and start the scheduler task. */
+	vSchedulerInit();
+#else
+	vTaskStartScheduler();
+#endif
+
+	/* The execution should never reach here. */
+	for (;;);
+}
+
+/**
+ * Periodic task body.
+ */
+static void task_body( void* params )
+{
+#if ( configUSE_HST == 1 )
+	/* The HST passes the eTCB as parameter, find the task by its number. */
+	BenchTask_t *pxTask = &( xTasks[ uxTaskGetTaskNumber( xTaskGetCurrentTaskHandle() ) - 1 ] );
+
+	for (;;)
+	{
+		xUtilsWorkloadRun( &( pxTask->xWorkload ) );
+
+		vBenchJobEnd();
+		vSchedulerWaitForNextPeriod();
+	}
+#else
+	BenchTask_t *pxTask = ( BenchTask_t * ) params;
+	TickType_t xRelease = xTaskGetTickCount();
+
+	for (;;)
+	{
+		xUtilsWorkloadRun( &( pxTask->xWorkload ) );
+
+		vBenchJobEnd();
+
+		/* Implicit deadlines. */
+		if( xTaskGetTickCount() > xRelease + pxTask->xPeriod )
+		{
+			vBenchDeadlineMiss();
+		}
+
+		vTaskDelayUntil( &xRelease, pxTask->xPeriod );
+	}
+#endif
+
+	/* If the tasks ever leaves the for loop, kill it. */
+	vTaskDelete( NULL );
+}
+
+#if ( USE_SLACK_STEALING == 1 ) || ( USE_EDL_SLACK == 1 ) || ( USE_RECLAIMING == 1 )
+/**
+ * Aperiodic task body. Every run draws the same arrivals, so the response
+ * times of the slack methods can be compared.
+ */
+static void aperiodic_body( void* params )
+{
+	/* Mean interarrival time, in ticks. */
+	const uint32_t ulMean = ( BENCH_APERIODIC_WCET * 100 ) / BENCH_APERIODIC_LOAD;
+
+	/* Own xorshift state: ulUtilsRandom() is also drawn by the periodic
+	 * workloads, in an order that depends on the schedule. */
+	uint32_t ulState = BENCH_APERIODIC_SEED;
+
+	for (;;)
+	{
+		ulState ^= ulState << 13;
+		ulState ^= ulState >> 17;
+		ulState ^= ulState << 5;
+
+		const TickType_t xDelay = ( TickType_t ) ( 1 + ( ulState % ( 2 * ulMean - 1 ) ) );
+		const TickType_t xArrival = xTaskGetTickCount() + xDelay;
+
+		vTaskDelay( xDelay );
+
+		vUtilsEatCpu( BENCH_APERIODIC_WCET );
+
+		vBenchAperiodic( xTaskGetTickCount() - xArrival );
+	}
+
+	/* If the tasks ever leaves the for loop, kill it. */
+	vTaskDelete( NULL );
+}
+#endif
+
+/**
+ * Waits the warm up, measures BENCH_TICKS ticks and prints the results as a
+ * single JSON line, so the output of every board and policy can be collected
+ * by the same script.
+ */
+static void reporter_body( void* params )
+{
+	vTaskDelay( BENCH_WARMUP_TICKS );
+
+	vBenchStart();
+	vTaskDelay( BENCH_TICKS );
+	vBenchStop();
+
+	const BenchStats_t *pxStats = pxBenchGetStats();
+
+	const uint32_t ulCyclesPerTick = configCPU_CLOCK_HZ / configTICK_RATE_HZ;
+	const uint64_t ullWindow = ( uint64_t ) pxStats->xTicks * ulCyclesPerTick;
+
+	/* RAM: kernel and HST objects allocated from the heap (TCBs, stacks,
+	 * eTCBs), and the smallest stack margin of the benchmark tasks. */
+	const unsigned long ulHeapUsed = ( unsigned long ) ( configTOTAL_HEAP_SIZE - xPortGetFreeHeapSize() );
+	UBaseType_t uxStackMinFree = uxTaskGetStackHighWaterMark( NULL );
+
+	for( UBaseType_t uxI = 0; uxI < BENCH_TASKS; uxI++ )
+	{
+		if( xTasks[ uxI ].xHandle != NULL )
+		{
+			const UBaseType_t uxFree = uxTaskGetStackHighWaterMark( xTasks[ uxI ].xHandle );
+
+			if( uxFree < uxStackMinFree )
+			{
+				uxStackMinFree = uxFree;
+			}
+		}
+	}
+
+#if ( configUSE_HST == 1 )
+	/* Analysis of the task set charging the measured overheads. */
+	const long lSchedulable = ( long ) xBenchSchedulableWithOverheads();
+#else
+	const long lSchedulable = -1;
+#endif
+
+	#define BENCH_AVG( x ) ( ( unsigned long ) ( ( x ).ulCount > 0 ? ( x ).ullSum / ( x ).ulCount : 0 ) )
+	#define BENCH_PERMILLE( x ) ( ( unsigned long ) ( ullWindow > 0 ? ( ( x ).ullSum * 1000 ) / ullWindow : 0 ) )
+
+	vTaskSuspendAll();
+	pc.printf( "{\"kernel\":\"%s\",\"board\":\"%s\",\"policy\":\"%s\",\"tasks\":%u,\"ticks\":%lu,\"cpu_hz\":%lu,",
+			tskKERNEL_VERSION_NUMBER, BENCH_BOARD, BENCH_POLICY, ( unsigned ) BENCH_TASKS, ( unsigned long ) pxStats->xTicks, ( unsigned long ) configCPU_CLOCK_HZ );
+	pc.printf( "\"hst_permille\":%lu,\"tick_hook_permille\":%lu,\"switches_per_s\":%lu,",
+			BENCH_PERMILLE( pxStats->xScheduler ), BENCH_PERMILLE( pxStats->xTickHook ),
+			( unsigned long ) ( pxStats->xTicks > 0 ? ( ( uint64_t ) pxStats->ulContextSwitches * configTICK_RATE_HZ ) / pxStats->xTicks : 0 ) );
+	pc.printf( "\"latency_avg\":%lu,\"latency_max\":%lu,\"tick_isr_avg\":%lu,\"tick_isr_max\":%lu,\"tick_hook_avg\":%lu,\"tick_hook_max\":%lu,\"hst_avg\":%lu,\"hst_max\":%lu,",
+			BENCH_AVG( pxStats->xLatency ), ( unsigned long ) pxStats->xLatency.ulMax,
+			BENCH_AVG( pxStats->xTickIsr ), ( unsigned long ) pxStats->xTickIsr.ulMax,
+			BENCH_AVG( pxStats->xTickHook ), ( unsigned long ) pxStats->xTickHook.ulMax,
+			BENCH_AVG( pxStats->xScheduler ), ( unsigned long ) pxStats->xScheduler.ulMax );
+	pc.printf( "\"dispatch_avg\":%lu,\"dispatch_max\":%lu,\"heap_used\":%lu,\"stack_min_free\":%lu,",
+			BENCH_AVG( pxStats->xDispatch ), ( unsigned long ) pxStats->xDispatch.ulMax,
+			ulHeapUsed, ( unsigned long ) uxStackMinFree );
+#if ( USE_SLACK_STEALING == 1 )
+	const char * const pcSlackMethod = pcSlackMethods[ SLACK_METHOD ];
+#elif ( USE_EDL_SLACK == 1 )
+	const char * const pcSlackMethod = "edl";
+#elif ( USE_RECLAIMING == 1 )
+	const char * const pcSlackMethod = "reclaim";
+#else
+	const char * const pcSlackMethod = "none";
+#endif
+	pc.printf( "\"slack_method\":\"%s\",\"slack_per_job\":%lu,\"slack_max\":%lu,\"aperiodic_jobs\":%lu,\"aperiodic_avg\":%lu,\"aperiodic_max\":%lu,",
+			pcSlackMethod, ( unsigned long ) ( pxStats->ulJobs > 0 ? pxStats->xSlack.ullSum / pxStats->ulJobs : 0 ), ( unsigned long ) pxStats->xSlack.ulMax,
+			( unsigned long ) pxStats->xAperiodic.ulCount, BENCH_AVG( pxStats->xAperiodic ), ( unsigned long ) pxStats->xAperiodic.ulMax );
+#if ( configUSE_HST == 1 ) && ( configHST_ADAPTIVE_WCET == 1 )
+	pc.printf( "\"adaptive_analyses\":%lu,\"adaptive_reverts\":%lu,", ( unsigned long ) ulAdaptiveGetAnalyses(), ( unsigned long ) ulAdaptiveGetReverts() );
+#else
+	pc.printf( "\"adaptive_analyses\":0,\"adaptive_reverts\":0," );
+#endif
+	pc.printf( "\"schedulable_with_overheads\":%ld,\"deadline_misses\":%lu,\"overruns\":%lu}\n",
+			lSchedulable, ( unsigned long ) pxStats->ulDeadlineMisses, ( unsigned long ) pxStats->ulOverruns );
+	xTaskResumeAll();
+
+	#undef BENCH_AVG
+	#undef BENCH_PERMILLE
+
+	vTaskSuspend( NULL );
+
+	for (;;);
+}
+
+extern void vApplicationMallocFailedHook( void )
+{
+	taskDISABLE_INTERRUPTS();
+
+	DigitalOut led( LED2 );
+
+	for( ;; )
+	{
+        led = 1;
+        wait_ms(1000);
+        led = 0;
+        wait_ms(1000);
+	}
+}
+
+extern void vApplicationStackOverflowHook( TaskHandle_t pxTask, char *pcTaskName )
+{
+	taskDISABLE_INTERRUPTS();
+
+	DigitalOut led( LED3 );
+
+	for( ;; )
+	{
+        led = 1;
+        wait_ms(1000);
+        led = 0;
+        wait_ms(1000);
+	}
+}
+
+#if ( configUSE_HST == 1 )
+/* Misses and overruns are counted, not fatal, so the report is always
+ * printed. The hooks are called on every tick, count each release once. */
+extern void vSchedulerDeadlineMissHook( HstTCB_t * xTask, const TickType_t xTickCount )
+{
+	BenchTask_t *pxTask = &( xTasks[ uxTaskGetTaskNumber( xTask->xHandle ) - 1 ] );
+
+	if( pxTask->uxLastMissRelease != xTask->uxReleaseCount + 1 )
+	{
+		pxTask->uxLastMissRelease = xTask->uxReleaseCount + 1;
+		vBenchDeadlineMiss();
+	}
+}
+
+extern void vSchedulerWcetOverrunHook( HstTCB_t * xTask, const TickType_t xTickCount )
+{
+	BenchTask_t *pxTask = &( xTasks[ uxTaskGetTaskNumber( xTask->xHandle ) - 1 ] );
+
+	if( pxTask->uxLastOverrunRelease != xTask->uxReleaseCount + 1 )
+	{
+		pxTask->uxLastOverrunRelease = xTask->uxReleaseCount + 1;
+		vBenchOverrun();
+	}
+}
+
+extern void vSchedulerNegativeSlackHook( TickType_t xTickCount, BaseType_t xSlack )
+{
+}
+
+/* This function is invoked before RTOS scheduler is started. */
+extern void vSchedulerStartHook()
+{
+	pc.printf( "HST benchmark: %s, %u tasks\n", BENCH_POLICY, ( unsigned ) BENCH_TASKS );
+}
+#else
+/* Native FreeRTOS: empty tick hook, the baseline for the HST one. */
+extern void vApplicationTickHook( void )
+{
+	vBenchTickHookEnter();
+	vBenchTickHookExit();
+}
+#endif
@@ -0,0 +1,28 @@
+#!/bin/sh
+#
+# Builds the benchmark under slack stealing with each slack computation method
+# (SLACK_METHOD, hst/ss/slack.h), with the same task set and aperiodic load,
+# and keeps the binary and the size report of each build in bench_results/.
+#
+# Usage: examples/bench/slack.sh [make variables]
+#   e.g. examples/bench/slack.sh BOARD=lpc1768 BENCH_TASKS=8
+#
+# Flash each binary and collect the JSON line printed on the serial port; the
+# "slack_method" field tells the runs apart. slack_per_job is the cost, and
+# aperiodic_avg and aperiodic_max the accuracy, of each method.
+#
+set -e
+
+cd "$(dirname "$0")/../.."
+
+OUT=bench_results
+METHODS=${BENCH_SLACK_METHODS:-"SLACK_EXACT SLACK_APPROX SLACK_BOUNDED SLACK_FIXED SLACK_TABLE"}
+
+mkdir -p $OUT
+
+for m in $METHODS; do
+	make clean "$@" HST_SCHED=ss HST_EXAMPLE=bench HST_SLACK_METHOD=$m
+	make "$@" HST_SCHED=ss HST_EXAMPLE=bench HST_SLACK_METHOD=$m
+	cp build/hst.bin $OUT/hst-ss-$m.bin
+	make --no-print-directory size "$@" HST_SCHED=ss HST_EXAMPLE=bench HST_SLACK_METHOD=$m | tee $OUT/hst-ss-$m.size
+done
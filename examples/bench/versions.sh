@@ -0,0 +1,27 @@
+#!/bin/sh
+#
+# Builds the benchmark against each FreeRTOS version in the tree, with the same
+# task set and kernel settings, and keeps the binary and the size report of
+# each build in bench_results/.
+#
+# Usage: examples/bench/versions.sh [make variables]
+#   e.g. examples/bench/versions.sh BOARD=lpc1768 HST_SCHED=rm BENCH_TASKS=8
+#
+# Flash each binary and collect the JSON line printed on the serial port; the
+# "kernel" field tells the runs apart.
+#
+set -e
+
+cd "$(dirname "$0")/../.."
+
+OUT=bench_results
+VERSIONS=${BENCH_VERSIONS:-"v8.2.1 v9.0.0"}
+
+mkdir -p $OUT
+
+for v in $VERSIONS; do
+	make clean "$@" FREERTOS_VERSION=$v HST_EXAMPLE=bench
+	make "$@" FREERTOS_VERSION=$v HST_EXAMPLE=bench
+	cp build/hst.bin $OUT/hst-$v.bin
+	make --no-print-directory size "$@" FREERTOS_VERSION=$v HST_EXAMPLE=bench | tee $OUT/hst-$v.size
+done
@@ -30,6 +30,9 @@ int main() {
 	/* Set the baud rate of the serial port. */
 	pc.baud( 9600 );
 
+	/* Measure the workload kernels, so vUtilsEatCpu() matches the requested ticks. */
+	vUtilsCalibrate();
+
 	vSchedulerSetup();
 
 	/* Create the application scheduled tasks. */
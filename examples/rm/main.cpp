@@ -5,6 +5,7 @@
 #include "scheduler_logic.h"
 #include "utils.h"
 #include "semphr.h"
+#include "static_analysis.h"
 
 /* The extern "C" is required to avoid name mangling between C and C++ code. */
 extern "C"
@@ -21,6 +22,21 @@ void vSchedulerStartHook( void );
 
 static void task_body( void* params );
 
+/* Application scheduled tasks: name, period, deadline, wcet, offset and
+ * blocking, in priority order. */
+static constexpr HstStaticTask_t xTasks[] =
+{
+	{ "T01", 3000, 3000, 1000, 0, 0 },
+	{ "T02", 4000, 4000, 1000, 0, 0 },
+	{ "T03", 6000, 6000, 1000, 0, 0 },
+	{ "T04", 12000, 12000, 1000, 0, 0 },
+};
+
+/* Analysed by the compiler: an unschedulable task set does not build. */
+static_assert( xHstStaticSchedulable( xTasks ), "The task set is not schedulable." );
+
+static constexpr HstStaticTables_t< 4 > xTables = xHstStaticTables( xTasks );
+
 /* Create a Serial port, connected to the USBTX/USBRX pins; they represent the
  * pins that route to the interface USB Serial port so you can communicate with
  * a host PC. */
@@ -30,13 +46,16 @@ int main() {
 	/* Set the baud rate of the serial port. */
 	pc.baud( 9600 );
 
+	/* Measure the workload kernels, so vUtilsEatCpu() matches the requested ticks. */
+	vUtilsCalibrate();
+
 	vSchedulerSetup();
 
 	/* Create the application scheduled tasks. */
-    xSchedulerTaskCreate( task_body, "T01", 256, NULL, 0, NULL, 3000, 3000, 1000 );
-    xSchedulerTaskCreate( task_body, "T02", 256, NULL, 1, NULL, 4000, 4000, 1000 );
-    xSchedulerTaskCreate( task_body, "T03", 256, NULL, 2, NULL, 6000, 6000, 1000 );
-    xSchedulerTaskCreate( task_body, "T04", 256, NULL, 3, NULL, 12000, 12000, 1000 );
+	xHstStaticTaskSetCreate( xTasks, task_body, 256 );
+
+	/* The response times were computed at compile time. */
+	vHstStaticSetTables( xTables );
 
 	/* Create and start the scheduler task. */
 	vSchedulerInit();
@@ -5,6 +5,7 @@
 #include "scheduler_logic.h"
 #include "utils.h"
 #include "slack.h"
+#include "taskset.h"
 
 #define AP_MAX_DELAY 6
 #define START_TASK   "S"
@@ -39,6 +40,9 @@ int main() {
 	/* Set the baud rate of the serial port. */
 	pc.baud( 9600 );
 
+    /* Measure the workload kernels, so vUtilsEatCpu() matches the requested ticks. */
+    vUtilsCalibrate();
+
     vSchedulerSetup();
 
 	/* Create the application scheduled tasks. */
@@ -112,19 +116,13 @@ static void aperiodic_task_body( void* params )
 
 static void printTask( const char* start, const char* pcTaskName, const HstTCB_t * taskInfo )
 {
-	ListItem_t * pxAppTasksListItem;
-
 	vTaskSuspendAll();
 
 	pc.printf( "%d\t%s\t%s\t%d\t%d\t%d\t", xTaskGetTickCount(), pcTaskName, start, taskInfo->uxReleaseCount, taskInfo->xCur, xAvailableSlack );
 
-	pxAppTasksListItem = listGET_HEAD_ENTRY( pxAllTasksList );
-
-	while( listGET_END_MARKER( pxAllTasksList ) != pxAppTasksListItem )
+	for( UBaseType_t uxI = 0; uxI < xHstTaskSet.uxCount; uxI++ )
 	{
-		struct TaskInfo_Slack * s = ( struct TaskInfo_Slack * ) ( ( HstTCB_t * ) listGET_LIST_ITEM_OWNER( pxAppTasksListItem ) )->vExt;
-		pc.printf( "%d\t" , s->xSlack );
-		pxAppTasksListItem = listGET_NEXT( pxAppTasksListItem );
+		pc.printf( "%d\t" , xSlackGetSlack( uxI ) );
 	}
 	pc.printf( "\n\r" );
 
@@ -217,16 +215,15 @@ void vSchedulerWcetOverrunHook( HstTCB_t * xTask, const TickType_t xTickCount )
 extern void vSchedulerStartHook()
 {
 	pc.printf( "Rate Monotonic + Slack Stealing (RM+SS)\n" );
+#if ( SLACK_METHOD == SLACK_TABLE )
+	pc.printf( "Slack table -- %d bytes\n", xSlackGetTableSize() );
+#endif
 	pc.printf( "Slacks -- %d\t", xAvailableSlack );
 
-	ListItem_t * pxAppTasksListItem = listGET_HEAD_ENTRY( pxAllTasksList );
-
 	// Print slack values for the critical instant.
-	while( listGET_END_MARKER( pxAllTasksList ) != pxAppTasksListItem )
+	for( UBaseType_t uxI = 0; uxI < xHstTaskSet.uxCount; uxI++ )
 	{
-		TaskSs_t * s = ( TaskSs_t * ) ( ( HstTCB_t * ) listGET_LIST_ITEM_OWNER( pxAppTasksListItem ) )->vExt;
-		pc.printf( "%d\t" , s->xSlack );
-		pxAppTasksListItem = listGET_NEXT( pxAppTasksListItem );
+		pc.printf( "%d\t" , xSlackGetSlack( uxI ) );
 	}
 
 	pc.printf("\n");
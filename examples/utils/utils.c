@@ -1,24 +1,236 @@
 #include "utils.h"
+#include "task.h"
 
 #define ONE_TICK ( ( configCPU_CLOCK_HZ / configTICK_RATE_HZ ) - 1UL )
 
+/* Iterations per calibration run, and runs per kernel (the fastest wins, so
+ * an interrupt during one run does not skew the result). */
+#define utilsCALIBRATION_ITERATIONS  ( ( uint32_t ) 2000 )
+#define utilsCALIBRATION_RUNS        ( 3 )
+
+/* Ticks to measure, when calibrating against the tick. */
+#define utilsCALIBRATION_TICKS       ( ( TickType_t ) 10 )
+
+/* Buffer touched by the memory kernel. Must be a power of two, and the stride
+ * is chosen to land on a different cache line / flash prefetch each time. */
+#define utilsMEMORY_WORDS            ( 256 )
+#define utilsMEMORY_STRIDE           ( 9 )
+
+#if defined( __CORTEX_M3 ) || defined( __CORTEX_M4 )
+/* DWT cycle counter (ARMv7-M). Raw addresses, so this does not depend on the
+ * CMSIS version shipped with each board library. */
+#define utilsHAS_CYCLE_COUNTER       1
+#define utilsDEMCR                   ( *( volatile uint32_t * ) 0xE000EDFCUL )
+#define utilsDWT_CTRL                ( *( volatile uint32_t * ) 0xE0001000UL )
+#define utilsDWT_CYCCNT              ( *( volatile uint32_t * ) 0xE0001004UL )
+#define utilsDEMCR_TRCENA            ( 1UL << 24 )
+#define utilsDWT_CTRL_CYCCNTENA      ( 1UL )
+#else
+#define utilsHAS_CYCLE_COUNTER       0
+#endif
+
+static void prvUtilsKernel( UtilsKernel_t xKernel, uint32_t ulIterations );
+static uint32_t prvUtilsIterationsPerTick( UtilsKernel_t xKernel );
+
+/* Calibrated iterations per tick for each kernel, 0 if not calibrated. */
+static uint32_t ulIterationsPerTick[ UTILS_KERNEL_COUNT ] = { 0 };
+
+/* Memory kernel buffer. */
+static volatile uint32_t ulMemoryBuffer[ utilsMEMORY_WORDS ];
+
+/* Sink for the branchy kernel, so the compiler can not drop it. */
+static volatile uint32_t ulBranchSink = 0;
+
+/* Workload distributions random state. */
+static uint32_t ulRandomState = 0x2545F491UL;
+
+void vUtilsCalibrate( void )
+{
+	UtilsKernel_t xKernel;
+
+	for( xKernel = UTILS_KERNEL_SPIN; xKernel < UTILS_KERNEL_COUNT; xKernel++ )
+	{
+#if ( utilsHAS_CYCLE_COUNTER == 1 )
+		uint32_t ulBest = 0xFFFFFFFFUL;
+		BaseType_t xRun;
+
+		utilsDEMCR |= utilsDEMCR_TRCENA;
+		utilsDWT_CTRL |= utilsDWT_CTRL_CYCCNTENA;
+
+		for( xRun = 0; xRun < utilsCALIBRATION_RUNS; xRun++ )
+		{
+			const uint32_t ulStart = utilsDWT_CYCCNT;
+			prvUtilsKernel( xKernel, utilsCALIBRATION_ITERATIONS );
+			const uint32_t ulCycles = utilsDWT_CYCCNT - ulStart;
+
+			if( ulCycles < ulBest )
+			{
+				ulBest = ulCycles;
+			}
+		}
+
+		ulIterationsPerTick[ xKernel ] = ( uint32_t ) ( ( ( uint64_t ) ( ONE_TICK + 1UL ) * utilsCALIBRATION_ITERATIONS ) / ulBest );
+#else
+		uint32_t ulIterations = 0;
+
+		/* Synchronize with a tick edge. */
+		TickType_t xStart = xTaskGetTickCount();
+		while( xTaskGetTickCount() == xStart );
+
+		xStart = xTaskGetTickCount();
+		while( ( xTaskGetTickCount() - xStart ) < utilsCALIBRATION_TICKS )
+		{
+			prvUtilsKernel( xKernel, utilsCALIBRATION_ITERATIONS / 10 );
+			ulIterations = ulIterations + ( utilsCALIBRATION_ITERATIONS / 10 );
+		}
+
+		ulIterationsPerTick[ xKernel ] = ulIterations / utilsCALIBRATION_TICKS;
+#endif
+	}
+}
+
 void vUtilsEatCpu( UBaseType_t ticks )
 {
-	BaseType_t xI;
-
-	BaseType_t xLim = ( ticks * ONE_TICK ) / 20;
-
-	for( xI = 0; xI < xLim; xI++ )
-	{			
-		asm("nop");
-		asm("nop");
-		asm("nop");
-		asm("nop");
-		asm("nop");
-		asm("nop");
-		asm("nop");
-		asm("nop");
-		asm("nop");
-		asm("nop");
+	vUtilsEatCpuKernel( UTILS_KERNEL_SPIN, ( TickType_t ) ticks );
+}
+
+void vUtilsEatCpuKernel( UtilsKernel_t xKernel, TickType_t xTicks )
+{
+	uint32_t ulPerTick = prvUtilsIterationsPerTick( xKernel );
+
+	/* Split long requests, so the iteration count does not overflow. */
+	while( xTicks > 0 )
+	{
+		TickType_t xChunk = ( xTicks > ( TickType_t ) 1000 ) ? ( TickType_t ) 1000 : xTicks;
+
+		prvUtilsKernel( xKernel, ( uint32_t ) xChunk * ulPerTick );
+
+		xTicks = xTicks - xChunk;
+	}
+}
+
+TickType_t xUtilsWorkloadRun( const UtilsWorkload_t * pxWorkload )
+{
+	TickType_t xTicks = pxWorkload->xMax;
+
+	switch( pxWorkload->xDist )
+	{
+		case UTILS_DIST_UNIFORM:
+			xTicks = pxWorkload->xMin + ( TickType_t ) ( ulUtilsRandom() % ( uint32_t ) ( pxWorkload->xMax - pxWorkload->xMin + 1 ) );
+			break;
+
+		case UTILS_DIST_BIMODAL:
+			if( ( ulUtilsRandom() % 100UL ) >= ( uint32_t ) pxWorkload->uxHighPercent )
+			{
+				xTicks = pxWorkload->xMin;
+			}
+			break;
+
+		default:
+			break;
+	}
+
+	vUtilsEatCpuKernel( pxWorkload->xKernel, xTicks );
+
+	return xTicks;
+}
+
+void vUtilsRandomSeed( uint32_t ulSeed )
+{
+	/* xorshift must not be seeded with zero. */
+	ulRandomState = ( ulSeed != 0 ) ? ulSeed : 0x2545F491UL;
+}
+
+uint32_t ulUtilsRandom( void )
+{
+	uint32_t ulX = ulRandomState;
+
+	ulX ^= ulX << 13;
+	ulX ^= ulX >> 17;
+	ulX ^= ulX << 5;
+
+	ulRandomState = ulX;
+
+	return ulX;
+}
+
+uint32_t ulUtilsCycleCount( void )
+{
+#if ( utilsHAS_CYCLE_COUNTER == 1 )
+	return utilsDWT_CYCCNT;
+#else
+	return 0;
+#endif
+}
+
+static uint32_t prvUtilsIterationsPerTick( UtilsKernel_t xKernel )
+{
+	if( ulIterationsPerTick[ xKernel ] == 0 )
+	{
+		/* Not calibrated: assume each iteration costs 20 cycles. */
+		return ONE_TICK / 20;
+	}
+
+	return ulIterationsPerTick[ xKernel ];
+}
+
+static void prvUtilsKernel( UtilsKernel_t xKernel, uint32_t ulIterations )
+{
+	uint32_t ulI;
+
+	switch( xKernel )
+	{
+		case UTILS_KERNEL_MEMORY:
+		{
+			uint32_t ulIndex = 0;
+
+			for( ulI = 0; ulI < ulIterations; ulI++ )
+			{
+				ulIndex = ( ulIndex + utilsMEMORY_STRIDE ) & ( utilsMEMORY_WORDS - 1 );
+				ulMemoryBuffer[ ulIndex ] = ulMemoryBuffer[ ulIndex ] + ulI;
+			}
+			break;
+		}
+
+		case UTILS_KERNEL_BRANCHY:
+		{
+			/* Private LFSR state, so the distributions stay reproducible. */
+			uint32_t ulLfsr = 0xACE1UL + ulIterations;
+
+			for( ulI = 0; ulI < ulIterations; ulI++ )
+			{
+				ulLfsr = ( ulLfsr >> 1 ) ^ ( -( ulLfsr & 1UL ) & 0xB400UL );
+
+				if( ulLfsr & 0x1UL )
+				{
+					ulBranchSink = ulBranchSink + ulLfsr;
+				}
+				else if( ulLfsr & 0x8UL )
+				{
+					ulBranchSink = ulBranchSink ^ ( ulLfsr >> 3 );
+				}
+				else
+				{
+					ulBranchSink = ulBranchSink - 1UL;
+				}
+			}
+			break;
+		}
+
+		default:
+			for( ulI = 0; ulI < ulIterations; ulI++ )
+			{
+				asm("nop");
+				asm("nop");
+				asm("nop");
+				asm("nop");
+				asm("nop");
+				asm("nop");
+				asm("nop");
+				asm("nop");
+				asm("nop");
+				asm("nop");
+			}
+			break;
 	}
 }
@@ -3,16 +3,155 @@
 #define U_CEIL( x, y )    ( ( x / y ) + ( x % y != 0 ) )
 #define U_FLOOR( x, y )   ( x / y )
 
+/* Division-free variants, r is the reciprocal of y from ulUtilsReciprocal(). */
+#define U_CEIL_R( x, y, r )    ulUtilsDivCeil( ( x ), ( y ), ( r ) )
+#define U_FLOOR_R( x, y, r )   ulUtilsDivFloor( ( x ), ( y ), ( r ) )
+
+/**
+ * Fixed-point reciprocal of ulDivisor, floor( ( 2^32 - 1 ) / ulDivisor ). It
+ * divides, so compute it once, e.g. when a task is created, and use it with
+ * ulUtilsDivFloor() and ulUtilsDivCeil() in the analysis loops.
+ *
+ * @param ulDivisor must be greater than zero.
+ * @return the reciprocal of ulDivisor.
+ */
+static inline uint32_t ulUtilsReciprocal( uint32_t ulDivisor )
+{
+	return 0xFFFFFFFFUL / ulDivisor;
+}
+
+/**
+ * floor( ulX / ulDivisor ) with a multiply, a shift and one correction step.
+ * The estimate ( ulX * ulRecip ) >> 32 is the exact quotient or one less, for
+ * every 32 bit ulX.
+ *
+ * @param ulX
+ * @param ulDivisor
+ * @param ulRecip reciprocal of ulDivisor, from ulUtilsReciprocal().
+ * @return floor( ulX / ulDivisor ).
+ */
+static inline uint32_t ulUtilsDivFloor( uint32_t ulX, uint32_t ulDivisor, uint32_t ulRecip )
+{
+	uint32_t ulQ = ( uint32_t ) ( ( ( uint64_t ) ulX * ulRecip ) >> 32 );
+
+	if( ( ulX - ( ulQ * ulDivisor ) ) >= ulDivisor )
+	{
+		ulQ++;
+	}
+
+	return ulQ;
+}
+
+/**
+ * ceil( ulX / ulDivisor ), without dividing. See ulUtilsDivFloor().
+ *
+ * @param ulX
+ * @param ulDivisor
+ * @param ulRecip reciprocal of ulDivisor, from ulUtilsReciprocal().
+ * @return ceil( ulX / ulDivisor ).
+ */
+static inline uint32_t ulUtilsDivCeil( uint32_t ulX, uint32_t ulDivisor, uint32_t ulRecip )
+{
+	uint32_t ulQ = ( uint32_t ) ( ( ( uint64_t ) ulX * ulRecip ) >> 32 );
+	uint32_t ulR = ulX - ( ulQ * ulDivisor );
+
+	if( ulR >= ulDivisor )
+	{
+		ulQ++;
+		ulR = ulR - ulDivisor;
+	}
+
+	return ulQ + ( ulR != 0 );
+}
+
+/**
+ * Synthetic workload kernels.
+ */
+typedef enum
+{
+	UTILS_KERNEL_SPIN,   //!< Register only nop loop.
+	UTILS_KERNEL_MEMORY, //!< Strided read-modify-write over a RAM buffer.
+	UTILS_KERNEL_BRANCHY,//!< Data dependent, hard to predict branches.
+	UTILS_KERNEL_COUNT
+} UtilsKernel_t;
+
+/**
+ * Per job execution time distributions.
+ */
+typedef enum
+{
+	UTILS_DIST_FIXED,    //!< Every job executes xMax ticks.
+	UTILS_DIST_UNIFORM,  //!< Uniformly distributed in [xMin, xMax].
+	UTILS_DIST_BIMODAL   //!< xMax with uxHighPercent probability, xMin otherwise.
+} UtilsDist_t;
+
+/**
+ * Synthetic workload description.
+ */
+typedef struct
+{
+	UtilsKernel_t xKernel;       /* Kernel executed by each job. */
+	UtilsDist_t xDist;           /* Execution time distribution. */
+	TickType_t xMin;             /* Shortest job, in ticks. */
+	TickType_t xMax;             /* Longest job, in ticks. Should not exceed xWcet. */
+	UBaseType_t uxHighPercent;   /* Probability (0-100) of the long mode (bimodal). */
+} UtilsWorkload_t;
+
 #if defined (__cplusplus)
 extern "C" {
 #endif
 
 /**
+ * Measures how many iterations of each kernel fit in one tick. Uses the DWT
+ * cycle counter when the core has one, so it can be called from main() before
+ * vSchedulerInit(). Otherwise it measures against the tick, and must be called
+ * from a task once the scheduler is running.
+ */
+void vUtilsCalibrate( void );
+
+/**
+ * Consume ticks of CPU time with the spin kernel.
  *
  * @param ticks
  */
 void vUtilsEatCpu( UBaseType_t ticks );
 
+/**
+ * Consume xTicks of CPU time with the given kernel.
+ *
+ * @param xKernel
+ * @param xTicks
+ */
+void vUtilsEatCpuKernel( UtilsKernel_t xKernel, TickType_t xTicks );
+
+/**
+ * Execute one job of pxWorkload, drawing its length from the workload
+ * distribution.
+ *
+ * @param pxWorkload
+ * @return the execution time requested for this job, in ticks.
+ */
+TickType_t xUtilsWorkloadRun( const UtilsWorkload_t * pxWorkload );
+
+/**
+ * Seed the pseudo-random generator used by the workload distributions.
+ *
+ * @param ulSeed
+ */
+void vUtilsRandomSeed( uint32_t ulSeed );
+
+/**
+ *
+ * @return a pseudo-random 32 bit number (xorshift32).
+ */
+uint32_t ulUtilsRandom( void );
+
+/**
+ *
+ * @return the DWT cycle counter, or 0 if the core has no cycle counter.
+ */
+uint32_t ulUtilsCycleCount( void );
+
 #if defined (__cplusplus)
 }
 #endif
@@ -0,0 +1,299 @@
+#include "FreeRTOS.h"
+#include "scheduler.h"
+#include "scheduler_logic.h"  // USE_QPA
+#include "taskset.h"          // xHstTaskSet
+#include "adaptive.h"
+#include "wcrt.h"
+#if ( USE_QPA == 1 )
+#include "qpa.h"
+#endif
+#if ( USE_SLACK_STEALING == 1 )
+#include "slack.h"
+#elif ( USE_EDL_SLACK == 1 )
+#include "edl.h"
+#endif
+
+/**
+ * Estimates of a periodic task, by task set index.
+ */
+typedef struct AdaptiveTask
+{
+	TickType_t xDeclared;   /* Wcet given at the task creation. */
+	TickType_t xMaximum;    /* Largest execution time in the window. */
+	TickType_t xQuantile;   /* configHST_ADAPTIVE_QUANTILE quantile of the window. */
+	UBaseType_t uxNext;     /* Window position of the next sample. */
+	UBaseType_t uxFill;     /* Samples in the window. */
+} AdaptiveTask_t;
+
+static BaseType_t prvAdaptiveTest( void );
+static void prvAdaptiveEstimate( AdaptiveTask_t * pxTask, const TickType_t * pxWindow );
+static void prvAdaptiveRevert( void );
+static void prvAdaptiveSlack( const TickType_t xTc );
+
+static AdaptiveTask_t *pxTasks = NULL;
+static UBaseType_t uxTasks = 0U;
+
+/* configHST_ADAPTIVE_WINDOW samples per task, in task set order. */
+static TickType_t *pxSamples = NULL;
+
+/* A window in ascending order, to take its quantile. */
+static TickType_t pxSorted[ configHST_ADAPTIVE_WINDOW ];
+
+/* Set by the tick hook at a budget overrun. */
+static volatile BaseType_t xRevertPending = pdFALSE;
+
+static TickType_t xNextUpdate = 0U;
+
+static uint32_t ulAnalyses = 0U;
+static uint32_t ulReverts = 0U;
+
+BaseType_t xAdaptiveInit( void )
+{
+	UBaseType_t uxI;
+
+	pxTasks = ( AdaptiveTask_t * ) pvPortMalloc( xHstTaskSet.uxCount * sizeof( AdaptiveTask_t ) );
+	pxSamples = ( TickType_t * ) pvPortMalloc( xHstTaskSet.uxCount * configHST_ADAPTIVE_WINDOW * sizeof( TickType_t ) );
+
+	if( ( pxTasks == NULL ) || ( pxSamples == NULL ) )
+	{
+		uxTasks = 0U;
+		return pdFAIL;
+	}
+
+	for( uxI = 0; uxI < xHstTaskSet.uxCount; uxI++ )
+	{
+		pxTasks[ uxI ].xDeclared = xHstTaskSet.pxWcet[ uxI ];
+		pxTasks[ uxI ].xMaximum = 0U;
+		pxTasks[ uxI ].xQuantile = 0U;
+		pxTasks[ uxI ].uxNext = 0U;
+		pxTasks[ uxI ].uxFill = 0U;
+	}
+
+	xNextUpdate = configHST_ADAPTIVE_PERIOD;
+	uxTasks = xHstTaskSet.uxCount;
+
+	return pdPASS;
+}
+
+void vAdaptiveJobEnd( const HstTCB_t * pxTask )
+{
+	if( pxTask->uxIndex >= uxTasks )
+	{
+		return;
+	}
+
+	AdaptiveTask_t * const pxEstimate = &( pxTasks[ pxTask->uxIndex ] );
+
+	/* The oldest sample is replaced. */
+	pxSamples[ pxTask->uxIndex * configHST_ADAPTIVE_WINDOW + pxEstimate->uxNext ] = pxTask->xCur;
+
+	pxEstimate->uxNext = ( pxEstimate->uxNext + 1U < configHST_ADAPTIVE_WINDOW ) ? pxEstimate->uxNext + 1U : 0U;
+
+	if( pxEstimate->uxFill < configHST_ADAPTIVE_WINDOW )
+	{
+		pxEstimate->uxFill++;
+	}
+}
+
+BaseType_t xAdaptiveOverrun( HstTCB_t * pxTask )
+{
+	if( ( pxTask->uxIndex >= uxTasks ) || ( pxTask->xWcet >= pxTasks[ pxTask->uxIndex ].xDeclared ) )
+	{
+		return pdFALSE;
+	}
+
+	/* The job goes on with its declared wcet, the HST reverts the others. */
+	pxTask->xWcet = pxTasks[ pxTask->uxIndex ].xDeclared;
+	xRevertPending = pdTRUE;
+
+	return pdTRUE;
+}
+
+void vAdaptiveUpdate( const TickType_t xTc )
+{
+	UBaseType_t uxI;
+
+	if( uxTasks == 0U )
+	{
+		return;
+	}
+
+	if( xRevertPending == pdTRUE )
+	{
+		prvAdaptiveRevert();
+		prvAdaptiveSlack( xTc );
+		ulReverts++;
+
+		xNextUpdate = xTc + configHST_ADAPTIVE_PERIOD;
+		return;
+	}
+
+	if( xTc < xNextUpdate )
+	{
+		return;
+	}
+
+	xNextUpdate = xTc + configHST_ADAPTIVE_PERIOD;
+
+	for( uxI = 0; uxI < uxTasks; uxI++ )
+	{
+		prvAdaptiveEstimate( &( pxTasks[ uxI ] ), &( pxSamples[ uxI * configHST_ADAPTIVE_WINDOW ] ) );
+	}
+
+#if ( configHST_ADAPTIVE_REANALYSIS == 1 )
+	BaseType_t xChanged = pdFALSE;
+
+	for( uxI = 0; uxI < uxTasks; uxI++ )
+	{
+		const AdaptiveTask_t * const pxEstimate = &( pxTasks[ uxI ] );
+		TickType_t xBudget = pxEstimate->xDeclared;
+
+		if( pxEstimate->uxFill == configHST_ADAPTIVE_WINDOW )
+		{
+			/* One tick more, as xCur counts the ticks seen by the job. */
+			const TickType_t xEstimate = pxEstimate->xQuantile + ( ( pxEstimate->xQuantile * configHST_ADAPTIVE_MARGIN ) / 100U ) + 1U;
+
+			if( xEstimate < xBudget )
+			{
+				xBudget = xEstimate;
+			}
+		}
+
+		if( xBudget != xHstTaskSet.pxWcet[ uxI ] )
+		{
+			xHstTaskSet.pxWcet[ uxI ] = xBudget;
+			xHstTaskSet.pxTask[ uxI ]->xWcet = xBudget;
+			xChanged = pdTRUE;
+		}
+	}
+
+	if( xChanged == pdTRUE )
+	{
+		ulAnalyses++;
+
+		if( prvAdaptiveTest() == pdFALSE )
+		{
+			/* Not schedulable with the budgets, e.g. a larger blocking
+			 * share: the declared task set was. */
+			prvAdaptiveRevert();
+		}
+
+		prvAdaptiveSlack( xTc );
+	}
+#endif
+}
+
+TickType_t xAdaptiveGetMaximum( const UBaseType_t uxIndex )
+{
+	return ( uxIndex < uxTasks ) ? pxTasks[ uxIndex ].xMaximum : 0U;
+}
+
+TickType_t xAdaptiveGetQuantile( const UBaseType_t uxIndex )
+{
+	return ( uxIndex < uxTasks ) ? pxTasks[ uxIndex ].xQuantile : 0U;
+}
+
+TickType_t xAdaptiveGetDeclared( const UBaseType_t uxIndex )
+{
+	return ( uxIndex < uxTasks ) ? pxTasks[ uxIndex ].xDeclared : 0U;
+}
+
+uint32_t ulAdaptiveGetAnalyses( void )
+{
+	return ulAnalyses;
+}
+
+uint32_t ulAdaptiveGetReverts( void )
+{
+	return ulReverts;
+}
+
+/**
+ * The policy test, as in vSchedulerInit(). Sets the xWcrt of each task.
+ */
+static BaseType_t prvAdaptiveTest( void )
+{
+#if ( USE_QPA == 1 )
+	return xQpaCalculateTasksSchedulability();
+#else
+	return xWcrtCalculateTasksWcrt();
+#endif
+}
+
+/**
+ * Maximum and quantile of a full window, by insertion sort: the window is
+ * small, and the order of the samples is lost anyway.
+ */
+static void prvAdaptiveEstimate( AdaptiveTask_t * pxTask, const TickType_t * pxWindow )
+{
+	UBaseType_t uxI;
+
+	if( pxTask->uxFill < configHST_ADAPTIVE_WINDOW )
+	{
+		return;
+	}
+
+	for( uxI = 0; uxI < configHST_ADAPTIVE_WINDOW; uxI++ )
+	{
+		const TickType_t xSample = pxWindow[ uxI ];
+		UBaseType_t uxJ = uxI;
+
+		while( ( uxJ > 0U ) && ( pxSorted[ uxJ - 1U ] > xSample ) )
+		{
+			pxSorted[ uxJ ] = pxSorted[ uxJ - 1U ];
+			uxJ--;
+		}
+
+		pxSorted[ uxJ ] = xSample;
+	}
+
+	/* The smallest sample with at least configHST_ADAPTIVE_QUANTILE percent
+	 * of the window at or below it. */
+	UBaseType_t uxRank = ( configHST_ADAPTIVE_QUANTILE * configHST_ADAPTIVE_WINDOW + 99U ) / 100U;
+
+	if( uxRank == 0U )
+	{
+		uxRank = 1U;
+	}
+
+	pxTask->xMaximum = pxSorted[ configHST_ADAPTIVE_WINDOW - 1U ];
+	pxTask->xQuantile = pxSorted[ uxRank - 1U ];
+}
+
+/**
+ * Every task back to its declared wcet, analysed again. The windows start
+ * empty, so new budgets need configHST_ADAPTIVE_WINDOW jobs more.
+ */
+static void prvAdaptiveRevert( void )
+{
+	UBaseType_t uxI;
+
+	xRevertPending = pdFALSE;
+
+	for( uxI = 0; uxI < uxTasks; uxI++ )
+	{
+		xHstTaskSet.pxWcet[ uxI ] = pxTasks[ uxI ].xDeclared;
+		xHstTaskSet.pxTask[ uxI ]->xWcet = pxTasks[ uxI ].xDeclared;
+
+		pxTasks[ uxI ].xQuantile = 0U;
+		pxTasks[ uxI ].uxNext = 0U;
+		pxTasks[ uxI ].uxFill = 0U;
+	}
+
+	( void ) prvAdaptiveTest();
+}
+
+/**
+ * The slack counters of the policy from the current wcets, as they were
+ * computed with the previous ones.
+ */
+static void prvAdaptiveSlack( const TickType_t xTc )
+{
+#if ( USE_SLACK_STEALING == 1 )
+	vSlackRecalculate( xTc );
+#elif ( USE_EDL_SLACK == 1 )
+	vEdlRecalculate( xTc );
+#else
+	( void ) xTc;
+#endif
+}
@@ -0,0 +1,103 @@
+#include "FreeRTOS.h"
+
+/**
+ * Online wcet estimation (configHST_ADAPTIVE_WCET). The HST keeps the
+ * execution times (xCur) of the last configHST_ADAPTIVE_WINDOW jobs of each
+ * periodic task, and every configHST_ADAPTIVE_PERIOD ticks computes their
+ * maximum and their configHST_ADAPTIVE_QUANTILE percent quantile.
+ *
+ * With configHST_ADAPTIVE_REANALYSIS set to 1, the quantile plus
+ * configHST_ADAPTIVE_MARGIN percent and one tick, never above the declared
+ * wcet, becomes the budget of the task: its xWcet, analysed again with the
+ * policy test. The slack counters (ss, edl) are computed again from the
+ * budgets, and the gains (USE_RECLAIMING) at a job end are the budget left. A
+ * job that runs past its budget reverts every task to its declared wcet, with
+ * the slack counters computed again, and the estimates start again from empty
+ * windows.
+ *
+ * Only the declared wcets are guaranteed: between a budget overrun and the
+ * HST activation that reverts the budgets, the slack handed out was computed
+ * with the budgets, and may exceed the one of the declared task set.
+ */
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * Allocates the windows, and keeps the wcets as the declared ones. Called by
+ * vSchedulerInit(), after the analysis.
+ *
+ * @return pdFAIL if there is not enough memory: nothing is measured.
+ */
+BaseType_t xAdaptiveInit( void );
+
+/**
+ * Records the execution time of the job of pxTask just finished. Constant
+ * time, from the HST.
+ *
+ * @param pxTask
+ */
+void vAdaptiveJobEnd( const HstTCB_t * pxTask );
+
+/**
+ * Called from the tick hook when the job of pxTask runs past xWcet. If xWcet
+ * was a budget below the declared wcet, restores the declared one for the
+ * task and asks the next vAdaptiveUpdate() to revert the others. Constant
+ * time.
+ *
+ * @param pxTask
+ * @return pdTRUE if it was a budget overrun, to wake up the HST. pdFALSE for
+ * a wcet overrun.
+ */
+BaseType_t xAdaptiveOverrun( HstTCB_t * pxTask );
+
+/**
+ * Reverts the budgets after an overrun. Otherwise, every
+ * configHST_ADAPTIVE_PERIOD ticks, updates the estimates and, with
+ * configHST_ADAPTIVE_REANALYSIS, analyses the task set with the new budgets,
+ * keeping the declared wcets if it is not schedulable. The slack counters
+ * (ss, edl) then follow the wcets. O(n W^2) plus the policy test and the
+ * slack computation, from the HST.
+ *
+ * @param xTc current time.
+ */
+void vAdaptiveUpdate( const TickType_t xTc );
+
+/**
+ *
+ * @param uxIndex task set index.
+ * @return largest execution time in the window, at the last update.
+ */
+TickType_t xAdaptiveGetMaximum( const UBaseType_t uxIndex );
+
+/**
+ *
+ * @param uxIndex task set index.
+ * @return configHST_ADAPTIVE_QUANTILE quantile of the window, at the last
+ * update. 0 until the window is full.
+ */
+TickType_t xAdaptiveGetQuantile( const UBaseType_t uxIndex );
+
+/**
+ *
+ * @param uxIndex task set index.
+ * @return wcet declared at the task creation.
+ */
+TickType_t xAdaptiveGetDeclared( const UBaseType_t uxIndex );
+
+/**
+ *
+ * @return analyses run with new budgets.
+ */
+uint32_t ulAdaptiveGetAnalyses( void );
+
+/**
+ *
+ * @return reverts to the declared wcets.
+ */
+uint32_t ulAdaptiveGetReverts( void );
+
+#if defined (__cplusplus)
+}
+#endif
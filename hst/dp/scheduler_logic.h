@@ -8,3 +8,6 @@ struct TaskInfo_DP {
 };
 
 typedef struct TaskInfo_DP TaskDp_t;
+
+/* The policy uses the response times (wcrt.h). */
+#define USE_EXACT_WCRT 1
@@ -1,6 +1,7 @@
 #include "FreeRTOS.h"
 #include "scheduler.h"
 #include "scheduler_logic.h"
+#include "resource.h"
 
 /* Periodic tasks list. */
 List_t xAllTasksList;
@@ -149,6 +150,9 @@ void vSchedulerTaskSchedulerLogic( HstTCB_t **pxCurrentTask )
 	{
 		*pxCurrentTask = ( HstTCB_t * ) listGET_OWNER_OF_HEAD_ENTRY( pxReadyTasksListC );
 	}
+
+	/* Stack Resource Policy: preempt only above the system ceiling. */
+	*pxCurrentTask = pxResourceGate( *pxCurrentTask );
 }
 
 /**
@@ -160,6 +164,23 @@ void vSchedulerLogicAddTaskToReadyList( HstTCB_t *xTask )
 	{
 		TaskDp_t * pxTaskDP = ( TaskDp_t * ) xTask->vExt;
 
+		if( ( pxTaskDP->xInUpperBand == pdFALSE ) && ( listIS_CONTAINED_WITHIN( &xPromotionList, &( pxTaskDP->xPromotionListItem ) ) == pdFALSE ) )
+		{
+			/* The promotion time is relative to the release. With D > T a
+			 * job can be released while the previous one still executes, so
+			 * its promotion time may have already passed. */
+			if( ( TickType_t ) ( xTaskGetTickCount() - xTask->xRelease ) >= ( TickType_t ) pxTaskDP->xPromotion )
+			{
+				listSET_LIST_ITEM_VALUE( &( xTask->xReadyListItem ), xTask->xPriority );
+				pxTaskDP->xInUpperBand = pdTRUE;
+			}
+			else
+			{
+				listSET_LIST_ITEM_VALUE( &( pxTaskDP->xPromotionListItem ), xTask->xRelease + pxTaskDP->xPromotion );
+				vListInsert( &xPromotionList, &( pxTaskDP->xPromotionListItem ) );
+			}
+		}
+
 		if( pxTaskDP->xInUpperBand == pdTRUE )
 		{
 			vListInsert( pxReadyTasksListA, &( xTask->xReadyListItem ) );
@@ -167,12 +188,6 @@ void vSchedulerLogicAddTaskToReadyList( HstTCB_t *xTask )
 		else
 		{
 			vListInsert( pxReadyTasksListC, &( xTask->xReadyListItem ) );
-
-			if( listIS_CONTAINED_WITHIN( &xPromotionList, &( pxTaskDP->xPromotionListItem ) ) == pdFALSE )
-			{
-				listSET_LIST_ITEM_VALUE( &( pxTaskDP->xPromotionListItem ), xTaskGetTickCount() + pxTaskDP->xPromotion );
-				vListInsert( &xPromotionList, &( pxTaskDP->xPromotionListItem ) );
-			}
 		}
 	}
 	else
@@ -0,0 +1,339 @@
+#include "FreeRTOS.h"
+#include "scheduler.h"
+#include "taskset.h"          // xHstTaskSet
+#include "wcrt.h"             // xWcrtGetOverhead
+#include "qpa.h"
+#include "utils.h"            // U_CEIL_R, U_FLOOR_R
+
+/* Utilizations are Q16 fixed-point numbers: 1.0 is qpaONE. */
+#define qpaONE    ( ( uint64_t ) 0x10000 )
+
+static TickType_t prvQpaDemand( TickType_t xT );
+static TickType_t prvQpaPreviousDeadline( TickType_t xT );
+static TickType_t prvQpaBound( void );
+static BaseType_t prvQpaCheck( TickType_t xL, TickType_t *pxFailed );
+
+/* Failing interval found by the last analysis, 0 if none. */
+static TickType_t xFailedInterval = 0U;
+static TickType_t xFailedDemand = 0U;
+
+/* Demand evaluations of the last analysis. */
+static UBaseType_t uxIterations = 0;
+
+/* Shortest relative deadline. */
+static TickType_t xMinDeadline = 0U;
+
+/**
+ * "QPA: A Fast Schedulability Test for EDF", Zhang and Burns.
+ *
+ * The deadlines in [0, L) are checked backwards, from the last one. Each step
+ * jumps from t to h(t) when h(t) < t, as no deadline in [h(t), t) can fail,
+ * and to the previous deadline when h(t) = t. QPA only tells whether some
+ * deadline fails, so on failure it runs again below the failing point, until
+ * the first failing interval is found. Only the rejection path repeats.
+ */
+BaseType_t xQpaCalculateTasksSchedulability( void )
+{
+	const UBaseType_t uxCount = xHstTaskSet.uxCount;
+	TickType_t xL;
+	TickType_t xFailed;
+	UBaseType_t uxI;
+
+	xFailedInterval = 0U;
+	xFailedDemand = 0U;
+	uxIterations = 0;
+
+	if( uxCount == 0 )
+	{
+		return pdTRUE;
+	}
+
+	xMinDeadline = xHstTaskSet.pxDeadline[ 0 ];
+
+	for( uxI = 1; uxI < uxCount; uxI++ )
+	{
+		if( xHstTaskSet.pxDeadline[ uxI ] < xMinDeadline )
+		{
+			xMinDeadline = xHstTaskSet.pxDeadline[ uxI ];
+		}
+	}
+
+	xL = prvQpaBound();
+
+	if( xL == 0U )
+	{
+		/* The utilization exceeds 1: the demand grows without bound. */
+		xFailedInterval = portMAX_DELAY;
+		xFailedDemand = portMAX_DELAY;
+		return pdFALSE;
+	}
+
+	if( prvQpaCheck( xL, &xFailed ) == pdFALSE )
+	{
+		/* Look for an earlier failing deadline. */
+		do
+		{
+			xFailedInterval = xFailed;
+		}
+		while( prvQpaCheck( xFailedInterval, &xFailed ) == pdFALSE );
+
+		xFailedDemand = prvQpaDemand( xFailedInterval );
+
+		return pdFALSE;
+	}
+
+	for( uxI = 0; uxI < uxCount; uxI++ )
+	{
+		xHstTaskSet.pxWcrt[ uxI ] = xHstTaskSet.pxDeadline[ uxI ];
+		xHstTaskSet.pxTask[ uxI ]->xWcrt = xHstTaskSet.pxDeadline[ uxI ];
+	}
+
+	return pdTRUE;
+}
+
+BaseType_t xQpaGetFailedInterval( TickType_t *pxInterval, TickType_t *pxDemand )
+{
+	*pxInterval = xFailedInterval;
+	*pxDemand = xFailedDemand;
+
+	return ( xFailedInterval != 0U ) ? pdTRUE : pdFALSE;
+}
+
+TickType_t xQpaGetBound( void )
+{
+	if( xHstTaskSet.uxCount == 0 )
+	{
+		return 0U;
+	}
+
+	return prvQpaBound();
+}
+
+UBaseType_t uxQpaGetIterations( void )
+{
+	return uxIterations;
+}
+
+/**
+ * QPA over the deadlines in [0, xL).
+ *
+ * @param pxFailed a failing deadline, when it returns pdFALSE.
+ * @return pdTRUE if no deadline in [0, xL) fails.
+ */
+static BaseType_t prvQpaCheck( TickType_t xL, TickType_t *pxFailed )
+{
+	TickType_t xT = prvQpaPreviousDeadline( xL );
+	TickType_t xH = prvQpaDemand( xT );
+
+	while( ( xH <= xT ) && ( xH > xMinDeadline ) )
+	{
+		if( xH < xT )
+		{
+			xT = xH;
+		}
+		else
+		{
+			xT = prvQpaPreviousDeadline( xT );
+		}
+
+		xH = prvQpaDemand( xT );
+	}
+
+	if( xH <= xMinDeadline )
+	{
+		return pdTRUE;
+	}
+
+	*pxFailed = xT;
+
+	return pdFALSE;
+}
+
+/**
+ * Processor demand h(t) of the jobs released at or after 0 with an absolute
+ * deadline at or before t, plus their overheads and the blocking B(t), the
+ * longest blocking term of the tasks with a relative deadline at or before t
+ * (Baker's Stack Resource Policy test).
+ */
+static TickType_t prvQpaDemand( TickType_t xT )
+{
+	const UBaseType_t uxCount = xHstTaskSet.uxCount;
+	const TickType_t * const pxPeriod = xHstTaskSet.pxPeriod;
+	const uint32_t * const pulPeriodRecip = xHstTaskSet.pulPeriodRecip;
+	const TickType_t * const pxWcet = xHstTaskSet.pxWcet;
+	const TickType_t * const pxDeadline = xHstTaskSet.pxDeadline;
+	const TickType_t * const pxBlocking = xHstTaskSet.pxBlocking;
+
+	uint64_t ullDemand = 0U;
+	TickType_t xBlocking = 0U;
+	uint32_t ulJobs = 0U;
+	UBaseType_t uxI;
+
+	uxIterations++;
+
+	for( uxI = 0; uxI < uxCount; uxI++ )
+	{
+		if( pxDeadline[ uxI ] <= xT )
+		{
+			const TickType_t xJobs = U_FLOOR_R( xT - pxDeadline[ uxI ], pxPeriod[ uxI ], pulPeriodRecip[ uxI ] ) + 1U;
+
+			ullDemand = ullDemand + ( ( uint64_t ) xJobs * pxWcet[ uxI ] );
+			ulJobs = ulJobs + xJobs;
+
+			if( pxBlocking[ uxI ] > xBlocking )
+			{
+				xBlocking = pxBlocking[ uxI ];
+			}
+		}
+	}
+
+	ullDemand = ullDemand + xBlocking;
+
+	/* Each job is dispatched, and may preempt another one, once. */
+	ullDemand = ullDemand + xWcrtGetOverhead( xT, ulJobs, ulJobs );
+
+	return ( ullDemand < portMAX_DELAY ) ? ( TickType_t ) ullDemand : portMAX_DELAY;
+}
+
+/**
+ * Latest absolute deadline before xT, or 0 if there is none.
+ */
+static TickType_t prvQpaPreviousDeadline( TickType_t xT )
+{
+	const UBaseType_t uxCount = xHstTaskSet.uxCount;
+	const TickType_t * const pxPeriod = xHstTaskSet.pxPeriod;
+	const uint32_t * const pulPeriodRecip = xHstTaskSet.pulPeriodRecip;
+	const TickType_t * const pxDeadline = xHstTaskSet.pxDeadline;
+
+	TickType_t xLatest = 0U;
+	UBaseType_t uxI;
+
+	for( uxI = 0; uxI < uxCount; uxI++ )
+	{
+		if( pxDeadline[ uxI ] < xT )
+		{
+			const TickType_t xD = pxDeadline[ uxI ] + ( U_FLOOR_R( xT - 1U - pxDeadline[ uxI ], pxPeriod[ uxI ], pulPeriodRecip[ uxI ] ) * pxPeriod[ uxI ] );
+
+			if( xD > xLatest )
+			{
+				xLatest = xD;
+			}
+		}
+	}
+
+	return xLatest;
+}
+
+/**
+ * End of the interval to check, one past the last deadline that can fail: the
+ * synchronous busy period, or the bound
+ *
+ *     max( D_max, sum( ( T_i - D_i ) * U_i ) / ( 1 - U ) )
+ *
+ * when the utilization is below 1 and it is shorter. Blocking may extend the
+ * busy period by the longest blocking term, and the bound then does not hold.
+ *
+ * @return the bound, or 0 if the utilization exceeds 1.
+ */
+static TickType_t prvQpaBound( void )
+{
+	const UBaseType_t uxCount = xHstTaskSet.uxCount;
+	const TickType_t * const pxPeriod = xHstTaskSet.pxPeriod;
+	const uint32_t * const pulPeriodRecip = xHstTaskSet.pulPeriodRecip;
+	const TickType_t * const pxWcet = xHstTaskSet.pxWcet;
+	const TickType_t * const pxDeadline = xHstTaskSet.pxDeadline;
+	const TickType_t * const pxBlocking = xHstTaskSet.pxBlocking;
+
+	uint64_t ullUtilizationLo = 0U;
+	uint64_t ullUtilizationHi = 0U;
+	uint64_t ullLaxity = 0U;
+	uint64_t ullBound = portMAX_DELAY;
+	TickType_t xMaxDeadline = 0U;
+	TickType_t xMaxBlocking = 0U;
+	TickType_t xW = 0U;
+	TickType_t xPrevious;
+	UBaseType_t uxI;
+
+	for( uxI = 0; uxI < uxCount; uxI++ )
+	{
+		/* Q16 utilization without dividing, as in wcrt.c. */
+		const uint64_t ullLo = ( ( uint64_t ) pxWcet[ uxI ] * pulPeriodRecip[ uxI ] ) >> 16;
+		const uint64_t ullHi = ullLo + 2U + ( pxWcet[ uxI ] >> 16 );
+
+		ullUtilizationLo = ullUtilizationLo + ullLo;
+		ullUtilizationHi = ullUtilizationHi + ullHi;
+
+		if( pxPeriod[ uxI ] > pxDeadline[ uxI ] )
+		{
+			ullLaxity = ullLaxity + ( ( uint64_t ) ( pxPeriod[ uxI ] - pxDeadline[ uxI ] ) * ullHi );
+		}
+
+		if( pxDeadline[ uxI ] > xMaxDeadline )
+		{
+			xMaxDeadline = pxDeadline[ uxI ];
+		}
+
+		if( pxBlocking[ uxI ] > xMaxBlocking )
+		{
+			xMaxBlocking = pxBlocking[ uxI ];
+		}
+
+		xW = xW + pxWcet[ uxI ];
+	}
+
+	xW = xW + xMaxBlocking;
+
+	if( ullUtilizationLo > qpaONE )
+	{
+		return 0U;
+	}
+
+	/* The bound assumes a free scheduler and independent tasks. */
+	if( ( ullUtilizationHi < qpaONE ) && ( xWcrtGetOverhead( 1U, 1U, 1U ) == 0U ) && ( xMaxBlocking == 0U ) )
+	{
+		ullBound = ( ullLaxity + ( qpaONE - ullUtilizationHi ) - 1U ) / ( qpaONE - ullUtilizationHi );
+
+		if( ullBound < xMaxDeadline )
+		{
+			ullBound = xMaxDeadline;
+		}
+
+		ullBound = ullBound + 1U;
+	}
+
+	/* Synchronous busy period, stopped at the bound. */
+	do
+	{
+		uint32_t ulJobs = 0U;
+		uint64_t ullWork = xMaxBlocking;
+
+		xPrevious = xW;
+
+		for( uxI = 0; uxI < uxCount; uxI++ )
+		{
+			const TickType_t xJobs = U_CEIL_R( xPrevious, pxPeriod[ uxI ], pulPeriodRecip[ uxI ] );
+
+			ullWork = ullWork + ( ( uint64_t ) xJobs * pxWcet[ uxI ] );
+			ulJobs = ulJobs + xJobs;
+		}
+
+		ullWork = ullWork + xWcrtGetOverhead( xPrevious, ulJobs, ulJobs );
+
+		if( ullWork >= ullBound )
+		{
+			if( ullBound >= portMAX_DELAY )
+			{
+				/* The busy period does not fit in a TickType_t. */
+				return 0U;
+			}
+
+			return ( TickType_t ) ullBound;
+		}
+
+		xW = ( TickType_t ) ullWork;
+	}
+	while( xW != xPrevious );
+
+	/* A deadline miss happens within the busy period. */
+	return xW + 1U;
+}
@@ -0,0 +1,48 @@
+#include "FreeRTOS.h"
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * EDF schedulability analysis of the task set (xHstTaskSet), with the Quick
+ * Processor-demand Analysis. Deadlines may be shorter than, equal to or longer
+ * than the periods. Charges the overheads set for the response time analysis
+ * (vWcrtSetOverheads()).
+ *
+ * When the task set is schedulable the xWcrt of each task is set to its
+ * deadline, the EDF bound of its response time.
+ *
+ * @return pdTRUE if the task set is schedulable.
+ */
+BaseType_t xQpaCalculateTasksSchedulability( void );
+
+/**
+ * First interval [0, t] in which the demand of the jobs with deadline at or
+ * before t exceeds t, found by the last xQpaCalculateTasksSchedulability().
+ *
+ * @param pxInterval t.
+ * @param pxDemand processor demand in [0, t].
+ * @return pdFALSE if the last analysis found no failing interval.
+ */
+BaseType_t xQpaGetFailedInterval( TickType_t *pxInterval, TickType_t *pxDemand );
+
+/**
+ * Length of the interval the analysis checks: the synchronous busy period,
+ * shortened by the utilization bound when it applies. Past it, the demand of
+ * the periodic jobs never exceeds the interval. Computed again at each call.
+ *
+ * @return the length, or 0 if the utilization exceeds 1 or the busy period
+ * does not fit in a TickType_t.
+ */
+TickType_t xQpaGetBound( void );
+
+/**
+ *
+ * @return demand evaluations of the last analysis.
+ */
+UBaseType_t uxQpaGetIterations( void );
+
+#if defined (__cplusplus)
+}
+#endif
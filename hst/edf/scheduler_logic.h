@@ -1,2 +1,13 @@
 
 extern List_t * pxAllTasksList;
+
+/* vSchedulerInit() runs the EDF processor demand analysis (qpa.h) instead of
+ * the fixed priority response time analysis. */
+#define USE_QPA 1
+
+/* Gain-time reclaiming (reclaim.h): the wcet the periodic jobs do not use
+ * runs the aperiodic tasks, at the deadline of the job that left it. Without
+ * it the policy does not tell the aperiodic tasks apart. */
+#ifndef USE_RECLAIMING
+	#define USE_RECLAIMING 0
+#endif
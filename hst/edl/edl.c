@@ -0,0 +1,463 @@
+#include "FreeRTOS.h"
+#include "scheduler.h"
+#include "taskset.h"
+#include "edl.h"
+#include "wcrt.h"
+#include "utils.h"
+
+/* Utilizations are Q16 fixed-point numbers: 1.0 is edlONE. */
+#define edlONE    ( ( uint64_t ) 0x10000 )
+
+/* Marks an empty group of tasks in the minima below. */
+#define edlNO_TASKS ( ( BaseType_t ) ( ( ~( UBaseType_t ) 0U ) >> 1U ) )
+
+BaseType_t xAvailableSlack = 0;
+
+/* One minus the utilization of the task set with its overheads, rounded
+ * down: the idle time of the EDL schedule grows at least this fast. 0 when
+ * there is none, and the slack is then always 0. */
+static uint64_t ullEdlSpare = 0U;
+
+/* Dispatch and preemption overheads of a job. */
+static TickType_t xEdlJobOverhead = 0U;
+
+/* Lazy accounting of the slack counters, as in hst/ss: the tick only counts
+ * the ticks to charge, the counters are brought up to date by vEdlSync(). The
+ * ticks in xEdlPendingLevel are charged to the tasks with a deadline before
+ * xEdlLevel (every task if xEdlLevelAll), the ones in xEdlPendingAll to every
+ * task. */
+static TickType_t xEdlLevel = 0U;
+static BaseType_t xEdlLevelAll = pdTRUE;
+static TickType_t xEdlPendingLevel = 0U;
+static TickType_t xEdlPendingAll = 0U;
+
+/* Minimum slack of the tasks charged by the tick, and of the other ones,
+ * with the pending ticks charged. */
+static BaseType_t xEdlMinCharged = 0;
+static BaseType_t xEdlMinOthers = 0;
+
+/* pdTRUE from vEdlRecalculate() to the next vEdlSetLevel(): the counters
+ * already count the jobs finished by then. */
+static BaseType_t xEdlRecalculated = pdFALSE;
+
+static void prvEdlSpare( void );
+static BaseType_t prvEdlSlack( const UBaseType_t uxIndex, const TickType_t xTc );
+
+/**
+ * Deadline of the current job of the task at uxIndex, or of the next one once
+ * the current job is finished. It only changes at the job ends.
+ */
+static inline TickType_t prvEdlFirstDeadline( const UBaseType_t uxIndex )
+{
+	return xHstTaskSet.pxTask[ uxIndex ]->xRelease + xHstTaskSet.pxDeadline[ uxIndex ];
+}
+
+/**
+ * The ticks of a job due at xEdlLevel use up the idle time before the
+ * earlier deadlines only.
+ */
+static inline BaseType_t prvEdlIsCharged( const UBaseType_t uxIndex, const TickType_t xLevel, const BaseType_t xAll )
+{
+	return ( ( xAll != pdFALSE ) || ( prvEdlFirstDeadline( uxIndex ) < xLevel ) ) ? pdTRUE : pdFALSE;
+}
+
+void vEdlInit( void )
+{
+	const UBaseType_t uxCount = xHstTaskSet.uxCount;
+	UBaseType_t uxI;
+
+	xEdlJobOverhead = xWcrtGetOverhead( 0U, 1U, 1U );
+
+	prvEdlSpare();
+
+	for( uxI = 0; uxI < uxCount; uxI++ )
+	{
+		xHstTaskSet.pxSlack[ uxI ] = prvEdlSlack( uxI, 0U );
+	}
+}
+
+void vEdlRecalculate( const TickType_t xTc )
+{
+	const UBaseType_t uxCount = xHstTaskSet.uxCount;
+	UBaseType_t uxI;
+
+	/* The ticks counted so far are in xTc already. */
+	vEdlSync();
+
+	prvEdlSpare();
+
+	for( uxI = 0; uxI < uxCount; uxI++ )
+	{
+		xHstTaskSet.pxSlack[ uxI ] = prvEdlSlack( uxI, xTc );
+	}
+
+	xEdlRecalculated = pdTRUE;
+	vEdlUpdateAvailableSlack( &xAvailableSlack );
+}
+
+/**
+ * One minus the utilization of the task set with its overheads, with the
+ * current wcets.
+ */
+static void prvEdlSpare( void )
+{
+	const UBaseType_t uxCount = xHstTaskSet.uxCount;
+	uint64_t ullUtilization;
+	UBaseType_t uxI;
+
+	/* The tick overhead, as a Q16 share of each tick. */
+	ullUtilization = xWcrtGetOverhead( ( TickType_t ) edlONE, 0U, 0U );
+
+	for( uxI = 0; uxI < uxCount; uxI++ )
+	{
+		/* Q16 utilization without dividing, never below C / T (wcrt.c). */
+		const uint64_t ullC = ( uint64_t ) xHstTaskSet.pxWcet[ uxI ] + xEdlJobOverhead;
+
+		ullUtilization = ullUtilization + ( ( ullC * xHstTaskSet.pulPeriodRecip[ uxI ] ) >> 16 ) + 2U + ( ullC >> 16 );
+	}
+
+	ullEdlSpare = ( ullUtilization < edlONE ) ? edlONE - ullUtilization : 0U;
+}
+
+void vEdlJobEnd( HstTCB_t * pxTask, const TickType_t xTc )
+{
+	xHstTaskSet.pxSlack[ pxTask->uxIndex ] = prvEdlSlack( pxTask->uxIndex, xTc );
+}
+
+/**
+ * Periodic work still to execute by the jobs due at or before xD: the jobs
+ * of each task up to xD, less the completed ones and the execution of the
+ * current job.
+ *
+ * @param pulJobs number of those jobs, for the overheads.
+ */
+static TickType_t prvEdlDemand( const TickType_t xD, uint32_t * const pulJobs )
+{
+	const UBaseType_t uxCount = xHstTaskSet.uxCount;
+	TickType_t xWork = 0U;
+	UBaseType_t uxI;
+
+	*pulJobs = 0U;
+
+	for( uxI = 0; uxI < uxCount; uxI++ )
+	{
+		const HstTCB_t * const pxTask = xHstTaskSet.pxTask[ uxI ];
+		/* Deadline of the first job. */
+		const TickType_t xFirst = xHstTaskSet.pxOffset[ uxI ] + xHstTaskSet.pxDeadline[ uxI ];
+		const TickType_t xWcet = xHstTaskSet.pxWcet[ uxI ];
+
+		if( xD >= xFirst )
+		{
+			const TickType_t xDue = U_FLOOR_R( xD - xFirst, xHstTaskSet.pxPeriod[ uxI ], xHstTaskSet.pulPeriodRecip[ uxI ] ) + 1U;
+
+			/* xRelease is the release of the current job, or of the next one
+			 * once the current job is finished. */
+			const TickType_t xDone = U_FLOOR_R( pxTask->xRelease - xHstTaskSet.pxOffset[ uxI ], xHstTaskSet.pxPeriod[ uxI ], xHstTaskSet.pulPeriodRecip[ uxI ] );
+
+			if( xDue > xDone )
+			{
+				xWork = xWork + ( ( xDue - xDone ) * xWcet );
+				*pulJobs = *pulJobs + ( xDue - xDone );
+
+				if( pxTask->xState != HST_FINISHED )
+				{
+					xWork = xWork - ( ( pxTask->xCur < xWcet ) ? pxTask->xCur : xWcet );
+				}
+			}
+		}
+	}
+
+	return xWork;
+}
+
+/**
+ * Bound of the periodic work in [xTc, d] past its growth with the
+ * utilization, whatever d: one job of each task, the jobs of the late tasks,
+ * and the rounding of the overheads.
+ */
+static TickType_t prvEdlBacklog( const TickType_t xTc )
+{
+	const UBaseType_t uxCount = xHstTaskSet.uxCount;
+	TickType_t xBacklog = 1U;
+	UBaseType_t uxI;
+
+	for( uxI = 0; uxI < uxCount; uxI++ )
+	{
+		const TickType_t xC = xHstTaskSet.pxWcet[ uxI ] + xEdlJobOverhead;
+		const TickType_t xFirst = prvEdlFirstDeadline( uxI );
+		TickType_t xJobs = 1U;
+
+		if( xTc > xFirst )
+		{
+			xJobs = xJobs + U_CEIL_R( xTc - xFirst, xHstTaskSet.pxPeriod[ uxI ], xHstTaskSet.pulPeriodRecip[ uxI ] );
+		}
+
+		xBacklog = xBacklog + ( xJobs * xC );
+	}
+
+	return xBacklog;
+}
+
+/**
+ * "Scheduling Periodic and Sporadic Tasks in a Real-Time System", Chetto
+ * and Chetto, and the dynamic slack stealer of Spuri and Buttazzo.
+ *
+ * The idle time of the EDL schedule before a deadline d is d - xTc less the
+ * periodic work due by d. It is checked at the deadlines of the task after
+ * xTc, in order, until it can only be larger: the work due by d grows with
+ * the utilization, so past d the idle time is at least
+ * ( 1 - U ) * ( d - xTc ) less the backlog (prvEdlBacklog()).
+ */
+static BaseType_t prvEdlSlack( const UBaseType_t uxIndex, const TickType_t xTc )
+{
+	const TickType_t xPeriod = xHstTaskSet.pxPeriod[ uxIndex ];
+	TickType_t xD = prvEdlFirstDeadline( uxIndex );
+	BaseType_t xK = edlNO_TASKS;
+	TickType_t xBacklog;
+
+	if( ullEdlSpare == 0U )
+	{
+		/* No idle time to steal. */
+		return 0;
+	}
+
+	xBacklog = prvEdlBacklog( xTc );
+
+	if( xD <= xTc )
+	{
+		/* A late job: its deadline was missed already. */
+		xD = xD + ( ( U_FLOOR_R( xTc - xD, xPeriod, xHstTaskSet.pulPeriodRecip[ uxIndex ] ) + 1U ) * xPeriod );
+	}
+
+	for( ;; )
+	{
+		const TickType_t xLength = xD - xTc;
+		uint32_t ulJobs;
+		TickType_t xWork = prvEdlDemand( xD, &ulJobs );
+
+		if( ulJobs > 0U )
+		{
+			xWork = xWork + xWcrtGetOverhead( xLength, ulJobs, ulJobs );
+		}
+
+		const int64_t llIdle = ( int64_t ) xLength - ( int64_t ) xWork;
+
+		if( llIdle < ( int64_t ) xK )
+		{
+			xK = ( BaseType_t ) llIdle;
+		}
+
+		const TickType_t xNext = xD + xPeriod;
+
+		if( xNext < xD )
+		{
+			/* No later deadline in a TickType_t. */
+			break;
+		}
+
+		if( ( ( int64_t ) xK + ( int64_t ) xBacklog <= 0 ) ||
+			( ( ( uint64_t ) ( xNext - xTc ) * ullEdlSpare ) >= ( ( uint64_t ) ( ( int64_t ) xK + ( int64_t ) xBacklog ) << 16 ) ) )
+		{
+			/* The idle time before the next deadlines is at least xK. */
+			break;
+		}
+
+		xD = xNext;
+	}
+
+	if( xK < 0 )
+	{
+		xK = 0;
+	}
+
+	return xK - ( BaseType_t ) xHstTaskSet.pxBlocking[ uxIndex ];
+}
+
+void vEdlGainSlack( const HstTCB_t * pxTask, const TickType_t xTicks )
+{
+	const UBaseType_t uxCount = xHstTaskSet.uxCount;
+	BaseType_t * const pxSlack = xHstTaskSet.pxSlack;
+
+	/* Deadline of the job just finished: xRelease is the next release. */
+	const TickType_t xDeadline = pxTask->xRelease - pxTask->xPeriod + pxTask->xDeadline;
+	UBaseType_t uxI;
+
+	if( xEdlRecalculated != pdFALSE )
+	{
+		return;
+	}
+
+	/* The work due by each later deadline is xTicks less. The tasks with an
+	 * earlier deadline keep their counters, a lower bound. */
+	for( uxI = 0; uxI < uxCount; uxI++ )
+	{
+		if( ( uxI != pxTask->uxIndex ) && ( prvEdlFirstDeadline( uxI ) >= xDeadline ) )
+		{
+			pxSlack[ uxI ] += ( BaseType_t ) xTicks;
+		}
+	}
+}
+
+void vEdlUpdateAvailableSlack( BaseType_t * xAvailableSlack )
+{
+	const UBaseType_t uxCount = xHstTaskSet.uxCount;
+	const BaseType_t * const pxSlack = xHstTaskSet.pxSlack;
+
+	BaseType_t xMin = 0;
+	UBaseType_t uxI;
+
+	if( uxCount == 0 )
+	{
+		*xAvailableSlack = 0;
+		return;
+	}
+
+	xMin = pxSlack[ 0 ];
+
+	for( uxI = 1; uxI < uxCount; uxI++ )
+	{
+		if( pxSlack[ uxI ] < xMin )
+		{
+			xMin = pxSlack[ uxI ];
+		}
+	}
+
+	*xAvailableSlack = xMin;
+}
+
+/**
+ * Slack left after xTicks ticks charged to a counter: each tick decrements
+ * the counter only while it is positive.
+ */
+static inline BaseType_t prvEdlCharge( const BaseType_t xSlack, const TickType_t xTicks )
+{
+	if( xSlack <= 0 )
+	{
+		return xSlack;
+	}
+
+	if( xSlack > ( BaseType_t ) xTicks )
+	{
+		return xSlack - ( BaseType_t ) xTicks;
+	}
+
+	return 0;
+}
+
+void vEdlTick( void )
+{
+	xEdlPendingLevel++;
+
+	if( xEdlMinCharged != edlNO_TASKS )
+	{
+		xEdlMinCharged = prvEdlCharge( xEdlMinCharged, 1U );
+	}
+
+	xAvailableSlack = ( xEdlMinCharged < xEdlMinOthers ) ? xEdlMinCharged : xEdlMinOthers;
+}
+
+void vEdlSync( void )
+{
+	const UBaseType_t uxCount = xHstTaskSet.uxCount;
+	BaseType_t * const pxSlack = xHstTaskSet.pxSlack;
+	TickType_t xAll, xPending, xLevel;
+	BaseType_t xLevelAll;
+	UBaseType_t uxI;
+
+	taskENTER_CRITICAL();
+	{
+		xAll = xEdlPendingAll;
+		xPending = xEdlPendingLevel;
+		xLevel = xEdlLevel;
+		xLevelAll = xEdlLevelAll;
+
+		xEdlPendingAll = 0U;
+		xEdlPendingLevel = 0U;
+	}
+	taskEXIT_CRITICAL();
+
+	if( ( xAll == 0U ) && ( xPending == 0U ) )
+	{
+		return;
+	}
+
+	for( uxI = 0; uxI < uxCount; uxI++ )
+	{
+		const TickType_t xTicks = ( prvEdlIsCharged( uxI, xLevel, xLevelAll ) != pdFALSE ) ? xAll + xPending : xAll;
+
+		pxSlack[ uxI ] = prvEdlCharge( pxSlack[ uxI ], xTicks );
+	}
+}
+
+void vEdlSetLevel( const HstTCB_t * pxTask )
+{
+	const UBaseType_t uxCount = xHstTaskSet.uxCount;
+	const BaseType_t * const pxSlack = xHstTaskSet.pxSlack;
+	const BaseType_t xAll = ( pxTask == NULL ) ? pdTRUE : pdFALSE;
+	const TickType_t xLevel = ( pxTask == NULL ) ? 0U : pxTask->xRelease + pxTask->xDeadline;
+	BaseType_t xCharged = edlNO_TASKS;
+	BaseType_t xOthers = edlNO_TASKS;
+	UBaseType_t uxI;
+
+	for( uxI = 0; uxI < uxCount; uxI++ )
+	{
+		if( prvEdlIsCharged( uxI, xLevel, xAll ) != pdFALSE )
+		{
+			xCharged = ( pxSlack[ uxI ] < xCharged ) ? pxSlack[ uxI ] : xCharged;
+		}
+		else
+		{
+			xOthers = ( pxSlack[ uxI ] < xOthers ) ? pxSlack[ uxI ] : xOthers;
+		}
+	}
+
+	if( uxCount == 0U )
+	{
+		/* No slack to steal. */
+		xCharged = 0;
+		xOthers = 0;
+	}
+
+	xEdlRecalculated = pdFALSE;
+
+	taskENTER_CRITICAL();
+	{
+		/* The ticks counted since vEdlSync() were charged to the previous
+		 * level: charge them to every task, which never overestimates the
+		 * slack of any of them. */
+		xEdlPendingAll = xEdlPendingAll + xEdlPendingLevel;
+		xEdlPendingLevel = 0U;
+		xEdlLevel = xLevel;
+		xEdlLevelAll = xAll;
+
+		if( xCharged != edlNO_TASKS )
+		{
+			xCharged = prvEdlCharge( xCharged, xEdlPendingAll );
+		}
+
+		if( xOthers != edlNO_TASKS )
+		{
+			xOthers = prvEdlCharge( xOthers, xEdlPendingAll );
+		}
+
+		xEdlMinCharged = xCharged;
+		xEdlMinOthers = xOthers;
+		xAvailableSlack = ( xCharged < xOthers ) ? xCharged : xOthers;
+	}
+	taskEXIT_CRITICAL();
+}
+
+BaseType_t xEdlGetSlack( const UBaseType_t uxIndex )
+{
+	BaseType_t xSlack;
+
+	taskENTER_CRITICAL();
+	{
+		const TickType_t xTicks = ( prvEdlIsCharged( uxIndex, xEdlLevel, xEdlLevelAll ) != pdFALSE ) ? xEdlPendingAll + xEdlPendingLevel : xEdlPendingAll;
+
+		xSlack = prvEdlCharge( xHstTaskSet.pxSlack[ uxIndex ], xTicks );
+	}
+	taskEXIT_CRITICAL();
+
+	return xSlack;
+}
@@ -0,0 +1,90 @@
+#include "FreeRTOS.h"
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+extern BaseType_t xAvailableSlack;
+
+/* The slack counters are stored in xHstTaskSet.pxSlack (taskset.h): the
+ * counter of a task is the smallest EDL idle time before its deadlines, the
+ * work the aperiodic jobs may take with every deadline still met. */
+
+/**
+ * Computes the slack counters at the start of the schedule, and the bound
+ * used by vEdlJobEnd() to stop the search. O(n) per deadline checked.
+ */
+void vEdlInit( void );
+
+/**
+ * Slack of the task at xTc, its job end: the least idle time of the EDL
+ * schedule before each deadline of the task, d - xTc less the periodic work
+ * still due by d, up to the point past which the idle time only grows.
+ * O(n) per deadline checked.
+ *
+ * @param pxTask
+ * @param xTc
+ */
+void vEdlJobEnd( HstTCB_t * pxTask, const TickType_t xTc );
+
+/**
+ * Slack of every task at xTc, and the bound of the search, after the wcets
+ * changed (adaptive.h). The counters then already count the jobs finished by
+ * xTc, so vEdlGainSlack() gives nothing until the next vEdlSetLevel(). O(n)
+ * per deadline checked, from the HST only.
+ *
+ * @param xTc
+ */
+void vEdlRecalculate( const TickType_t xTc );
+
+/**
+ * Gives xTicks, the unused wcet of the job of pxTask just finished, to the
+ * tasks with every deadline at or after the one of the job. O(n).
+ *
+ * @param pxTask
+ * @param xTicks
+ */
+void vEdlGainSlack( const HstTCB_t * pxTask, const TickType_t xTicks );
+
+/**
+ * Minimum of the slack counters, brought up to date by vEdlSync(). O(n),
+ * from the HST only.
+ *
+ * @param xAvailableSlack
+ */
+void vEdlUpdateAvailableSlack( BaseType_t * xAvailableSlack );
+
+/**
+ * Charges one tick to the tasks selected by vEdlSetLevel(), and updates
+ * xAvailableSlack. Only counts the tick, so it takes constant time: called
+ * from the tick hook.
+ */
+void vEdlTick( void );
+
+/**
+ * Charges to the slack counters the ticks counted by vEdlTick(). The HST
+ * calls it before reading or writing the counters.
+ */
+void vEdlSync( void );
+
+/**
+ * Selects the tasks the next ticks are charged to: the ones with a deadline
+ * before the one of pxTask, the running periodic task, or every task (NULL)
+ * while an aperiodic task or the idle task runs. Updates the minima kept for
+ * vEdlTick(), so it follows any change to the counters. O(n).
+ *
+ * @param pxTask
+ */
+void vEdlSetLevel( const HstTCB_t * pxTask );
+
+/**
+ * Slack of the task at uxIndex, with the ticks not yet charged by vEdlSync().
+ *
+ * @param uxIndex
+ * @return
+ */
+BaseType_t xEdlGetSlack( const UBaseType_t uxIndex );
+
+#if defined (__cplusplus)
+}
+#endif
@@ -0,0 +1,11 @@
+extern List_t * pxAllTasksList;
+
+/* The periodic tasks run by absolute deadline, so the analysis is QPA
+ * (qpa.h). */
+#define USE_QPA 1
+
+/* The policy keeps EDL slack counters (edl.h) for the aperiodic tasks. */
+#define USE_EDL_SLACK 1
+
+/* The aperiodic tasks are served in APERIODIC_ORDER (scheduler.h), as under
+ * ss. */
@@ -0,0 +1,360 @@
+#include "FreeRTOS.h"
+#include "scheduler.h"
+#include "scheduler_logic.h"
+#include "resource.h"
+#include "taskset.h"
+#include "edl.h"
+
+#define MIN_SLACK 0
+
+static BaseType_t xUsingSlack = pdFALSE;
+
+/* Slack granted to the optional steps not running, kept from the task using
+ * the slack: the HST selects again when the slack falls to it. */
+static BaseType_t xSlackReserved = 0;
+
+extern void vSchedulerNegativeSlackHook( TickType_t xTickCount, BaseType_t xSlack );
+
+static void prvSuspendAperiodicTasks( void );
+
+/* Periodic tasks list. */
+List_t xAllTasksList;
+List_t * pxAllTasksList = NULL;
+
+/* Aperiodic tasks list. */
+static List_t xAllAperiodicTasksList;
+static List_t * pxAllAperiodicTasksList = NULL;
+
+/* Ready tasks list, by absolute deadline. */
+static List_t xReadyTasksList;
+static List_t * pxReadyTasksList = NULL;
+
+/* Ready aperiodic / sporadic list. */
+static List_t xAperiodicReadyTasksList;
+static List_t * pxAperiodicReadyTasksList = NULL;
+
+/**
+ * AppSchedLogic_Init()
+ */
+void vSchedulerTaskSchedulerStartLogic( void )
+{
+	/* Initialize the ready task ready list. */
+	vListInitialise( &( xReadyTasksList ) );
+	pxReadyTasksList = &( xReadyTasksList );
+
+	/* Initialize the aperiodic task ready list. */
+	vListInitialise( &( xAperiodicReadyTasksList ) );
+	pxAperiodicReadyTasksList = &( xAperiodicReadyTasksList );
+
+	/* Slack counters at the start of the schedule. */
+	vEdlInit();
+
+	ListItem_t * pxAppTasksListItem = listGET_HEAD_ENTRY( pxAllTasksList );
+
+	/* Init periodic tasks, released at their offsets. */
+	while( listGET_END_MARKER( pxAllTasksList ) != pxAppTasksListItem )
+	{
+		HstTCB_t * pxAppTask = ( HstTCB_t * ) listGET_LIST_ITEM_OWNER( pxAppTasksListItem );
+
+		vSchedulerLogicAddTaskToReadyList( pxAppTask );
+
+		pxAppTasksListItem = listGET_NEXT( pxAppTasksListItem );
+	}
+
+	pxAppTasksListItem = listGET_HEAD_ENTRY( pxAllAperiodicTasksList );
+
+	/* Init aperiodic tasks. */
+	while( listGET_END_MARKER( pxAllAperiodicTasksList ) != pxAppTasksListItem )
+	{
+		HstTCB_t * pxAppTask = ( HstTCB_t * ) listGET_LIST_ITEM_OWNER( pxAppTasksListItem );
+
+		/* The first job arrives at 0. */
+		pxAppTask->xAbsoluteDeadline = pxAppTask->xDeadline;
+		vSchedulerLogicAddTaskToReadyList( pxAppTask );
+
+		pxAppTasksListItem = listGET_NEXT( pxAppTasksListItem );
+	}
+
+	/* No task running yet. */
+	vEdlSetLevel( NULL );
+}
+
+/**
+ * AppSchedLogic_Tick()
+ */
+BaseType_t vSchedulerTaskSchedulerTickLogic()
+{
+	BaseType_t xResult = pdFALSE;
+
+	/* ==================   Update slack   ================== */
+	/* Charge the tick to the tasks selected by the HST (vEdlSetLevel()), and
+	 * update the xAvailableSlack global counter with the minimum slack.
+	 * Constant time, whatever the number of tasks. */
+	vEdlTick();
+
+	if( xAvailableSlack < 0 )
+	{
+		vSchedulerNegativeSlackHook( xTaskGetTickCountFromISR(), xAvailableSlack );
+	}
+
+	/* If the system slack is below the minimum, wake up the scheduler. */
+	if( xUsingSlack == pdTRUE )
+	{
+		if( xAvailableSlack <= ( MIN_SLACK + xSlackReserved ) )
+		{
+			xResult = pdTRUE;
+		}
+	}
+
+	return xResult;
+}
+
+/**
+ * AppSchedLogic_Sched()
+ */
+void vSchedulerTaskSchedulerLogic( HstTCB_t **pxCurrentTask )
+{
+	/* Current RTOS tick value. */
+	const TickType_t xTickCount = xTaskGetTickCount();
+
+	traceHST_SLACK_ENTER();
+
+	/* Charge the ticks elapsed since the last call to the slack counters. */
+	vEdlSync();
+
+	/* Check if the current release of the periodic task has finished. */
+	if( *pxCurrentTask != NULL )
+	{
+		if( ( *pxCurrentTask )->xHstTaskType == HST_PERIODIC )
+		{
+			if( ( *pxCurrentTask )->xState == HST_FINISHED )
+			{
+				/* Only the slack of the task changes at its job end. */
+				vEdlJobEnd( *pxCurrentTask, xTickCount );
+
+				/* The wcet the counters were computed with: the task set one,
+				 * not a declared wcet restored by a budget overrun. */
+				const TickType_t xWcet = xHstTaskSet.pxWcet[ ( *pxCurrentTask )->uxIndex ];
+
+				if( xWcet > ( *pxCurrentTask )->xCur )
+				{
+					/* The release executed for less than the task worst case
+					 * execution time, so vEdlGainSlack() is called to assign
+					 * this time to the tasks due later. */
+					vEdlGainSlack( *pxCurrentTask, ( xWcet - ( *pxCurrentTask )->xCur ) );
+				}
+
+				/* Update the available slack. */
+				vEdlUpdateAvailableSlack( &xAvailableSlack );
+			}
+		}
+	}
+
+	traceHST_SLACK_EXIT();
+
+	if( xAvailableSlack < 0 )
+	{
+		vSchedulerNegativeSlackHook( xTickCount, xAvailableSlack );
+	}
+
+	/* The first periodic and aperiodic tasks in the ready lists, if any. */
+	HstTCB_t * const pxPeriodic = ( listLIST_IS_EMPTY( pxReadyTasksList ) == pdFALSE ) ? ( HstTCB_t * ) listGET_OWNER_OF_HEAD_ENTRY( pxReadyTasksList ) : NULL;
+	HstTCB_t * const pxAperiodic = ( listLIST_IS_EMPTY( pxAperiodicReadyTasksList ) == pdFALSE ) ? ( HstTCB_t * ) listGET_OWNER_OF_HEAD_ENTRY( pxAperiodicReadyTasksList ) : NULL;
+
+	/* The slack granted to the optional steps and not run yet. */
+	BaseType_t xReserved = ( BaseType_t ) xSchedulerOptionalReserved();
+
+	/* A firm job, first in APERIODIC_BY_DEADLINE order. */
+	BaseType_t xFirm = pdFALSE;
+
+#if ( APERIODIC_ORDER == APERIODIC_BY_DEADLINE )
+	xFirm = ( ( pxAperiodic != NULL ) && ( pxAperiodic->xDeadline > 0U ) ) ? pdTRUE : pdFALSE;
+#endif
+
+	/* The optional step requested by the job that was running starts if the
+	 * slack fits it (imprecise computation). A granted step runs to
+	 * completion whatever the slack is then: it goes on, or resumes once its
+	 * job is the first ready one. */
+	HstTCB_t * pxOptional = NULL;
+
+	if( ( *pxCurrentTask != NULL ) && ( ( ( *pxCurrentTask )->xOptionalStep > 0U ) || ( ( *pxCurrentTask )->xOptionalLeft > 0U ) ) )
+	{
+		pxOptional = *pxCurrentTask;
+	}
+	else if( ( pxPeriodic != NULL ) && ( pxPeriodic->xOptionalLeft > 0U ) )
+	{
+		pxOptional = pxPeriodic;
+	}
+
+	if( pxOptional != NULL )
+	{
+		const TickType_t xLeft = pxOptional->xOptionalLeft;
+
+		/* A new step only takes the slack not reserved. */
+		const BaseType_t xFree = xAvailableSlack - xReserved - MIN_SLACK;
+
+		if( xSchedulerOptionalGrant( pxOptional, ( xFree > 0 ) ? ( TickType_t ) xFree : 0U ) == pdFALSE )
+		{
+			pxOptional = NULL;
+		}
+		else
+		{
+			xReserved = xReserved + ( BaseType_t ) ( pxOptional->xOptionalLeft - xLeft );
+		}
+	}
+
+	*pxCurrentTask = NULL;
+
+	/* Only the aperiodic task selected below is resumed. */
+	prvSuspendAperiodicTasks();
+
+	if( ( xFirm == pdTRUE ) && ( ( xAvailableSlack - xReserved ) > MIN_SLACK ) )
+	{
+		/* Before the optional steps, which have no deadline of their own. */
+		*pxCurrentTask = pxAperiodic;
+		xUsingSlack = pdTRUE;
+		xSlackReserved = xReserved;
+	}
+	else if( pxOptional != NULL )
+	{
+		/* Before the other aperiodic tasks, charged as they are. */
+		*pxCurrentTask = pxOptional;
+		xUsingSlack = pdTRUE;
+		xSlackReserved = xReserved - ( BaseType_t ) pxOptional->xOptionalLeft;
+	}
+	else if( ( pxAperiodic != NULL ) && ( ( xAvailableSlack - xReserved ) > MIN_SLACK ) )
+	{
+		/* Resume the execution of the first aperiodic task in the ready list
+		 * (APERIODIC_ORDER), which preempts a less urgent one. The slack
+		 * is charged to every task whichever aperiodic task runs. */
+		*pxCurrentTask = pxAperiodic;
+		xUsingSlack = pdTRUE;
+		xSlackReserved = xReserved;
+	}
+	else
+	{
+		xUsingSlack = pdFALSE;
+
+		/* Resume the execution of the earliest deadline task, if any. */
+		*pxCurrentTask = pxPeriodic;
+	}
+
+	/* Stack Resource Policy: preempt only above the system ceiling. */
+	*pxCurrentTask = pxResourceGate( *pxCurrentTask );
+
+	if( ( xUsingSlack == pdFALSE ) && ( *pxCurrentTask != NULL ) && ( ( *pxCurrentTask )->xHstTaskType == HST_PERIODIC ) && ( ( *pxCurrentTask )->xOptionalLeft == 0U ) )
+	{
+		/* A RTT runs -- the next ticks decrement the slack of the tasks due
+		 * before it. */
+		vEdlSetLevel( *pxCurrentTask );
+	}
+	else
+	{
+		/* A NRTT or an optional step uses the available slack, or the Idle
+		 * task runs -- the next ticks decrement all slack counters. */
+		vEdlSetLevel( NULL );
+	}
+}
+
+/**
+ * Add xTask to the appropiate ready task list. A periodic task was released
+ * at xRelease, updated by vTaskDelayUntil().
+ */
+void vSchedulerLogicAddTaskToReadyList( HstTCB_t *xTask )
+{
+	if( xTask->xHstTaskType == HST_PERIODIC )
+	{
+		listSET_LIST_ITEM_VALUE( &( xTask->xReadyListItem ), xTask->xRelease + xTask->xDeadline );
+		vListInsert( pxReadyTasksList, &( xTask->xReadyListItem ) );
+	}
+	else
+	{
+		if( xTask->xState == HST_FINISHED )
+		{
+			/* A new aperiodic job, arrived now. */
+			xTask->xRelease = xTaskGetTickCountFromISR();
+			xTask->xAbsoluteDeadline = xTask->xRelease + xTask->xDeadline;
+			xTask->uxReleaseCount = xTask->uxReleaseCount + 1;
+			xTask->xCur = 0;
+		}
+
+#if ( APERIODIC_ORDER == APERIODIC_BY_DEADLINE )
+		/* Earliest absolute deadline first, the tasks without one last. */
+		listSET_LIST_ITEM_VALUE( &( xTask->xReadyListItem ), ( xTask->xDeadline > 0U ) ? xTask->xAbsoluteDeadline : portMAX_DELAY );
+#endif
+
+		vListInsert( pxAperiodicReadyTasksList, &( xTask->xReadyListItem ) );
+	}
+}
+
+/**
+ * Suspends the ready aperiodic tasks, as the HST does with the periodic ones:
+ * a task that arrives or is preempted does not run until selected again.
+ */
+static void prvSuspendAperiodicTasks( void )
+{
+	ListItem_t * pxItem = listGET_HEAD_ENTRY( pxAperiodicReadyTasksList );
+
+	while( listGET_END_MARKER( pxAperiodicReadyTasksList ) != pxItem )
+	{
+		HstTCB_t * pxTask = ( HstTCB_t * ) listGET_LIST_ITEM_OWNER( pxItem );
+
+		if( eTaskGetState( pxTask->xHandle ) == eReady )
+		{
+			vTaskSuspend( pxTask->xHandle );
+		}
+
+		pxItem = listGET_NEXT( pxItem );
+	}
+}
+
+/**
+ * Remove xTask from the ready task list.
+ */
+void vSchedulerLogicRemoveTaskFromReadyList( HstTCB_t *xTask )
+{
+	uxListRemove( &( xTask->xReadyListItem ) );
+}
+
+/**
+ * Add pxTask as a application scheduled task by the HST.
+ */
+void vSchedulerLogicAddTask( HstTCB_t * pxTask )
+{
+	/* Initialize the task's generic item list. The periodic tasks are in
+	 * relative deadline order, as in the edf policy. */
+	vListInitialiseItem( &( pxTask->xGenericListItem ) );
+	listSET_LIST_ITEM_OWNER( &( pxTask->xGenericListItem ), pxTask );
+	listSET_LIST_ITEM_VALUE( &( pxTask->xGenericListItem ), ( pxTask->xPeriod > 0U ) ? pxTask->xDeadline : pxTask->xPriority );
+
+	/* Initialize the task's ready item list. */
+	vListInitialiseItem( &( pxTask->xReadyListItem ) );
+	listSET_LIST_ITEM_OWNER( &( pxTask->xReadyListItem ), pxTask );
+	listSET_LIST_ITEM_VALUE( &( pxTask->xReadyListItem ), pxTask->xPriority );
+
+	/* Add the task to the correct appropiate task list. */
+	if( pxTask->xPeriod > 0U )
+	{
+		/* Periodic task. */
+		vListInsert( pxAllTasksList, &( pxTask->xGenericListItem ) );
+	}
+	else
+	{
+		/* Aperiodic task. */
+		vListInsert( pxAllAperiodicTasksList, &( pxTask->xGenericListItem ) );
+	}
+}
+
+/**
+ * Performs any previous work needed by the HST scheduler.
+ */
+void vSchedulerLogicSetup( void )
+{
+	/* Initialize the periodic task list. */
+	vListInitialise( &( xAllTasksList ) );
+	pxAllTasksList = &( xAllTasksList );
+
+	/* Initialize the aperiodic tasks list. */
+	vListInitialise( &( xAllAperiodicTasksList ) );
+	pxAllAperiodicTasksList = &( xAllAperiodicTasksList );
+}
@@ -0,0 +1,150 @@
+#include "FreeRTOS.h"
+#include "scheduler.h"
+#include "taskset.h"          // xHstTaskSet
+#include "reclaim.h"
+
+/* No gain selected. */
+#define reclaimNONE    ( ( UBaseType_t ) -1 )
+
+/**
+ * Unused wcet of the last finished job of a task.
+ */
+typedef struct ReclaimGain
+{
+	TickType_t xGain;
+	TickType_t xKey;
+	TickType_t xExpiry;
+} ReclaimGain_t;
+
+/* One per task, by task set index. */
+static ReclaimGain_t *pxGains = NULL;
+static UBaseType_t uxGains = 0U;
+
+/* Gain charged by the tick. */
+static UBaseType_t uxCurrent = reclaimNONE;
+
+static uint32_t ulReclaimed = 0U;
+
+BaseType_t xReclaimInit( void )
+{
+	UBaseType_t uxI;
+
+	pxGains = ( ReclaimGain_t * ) pvPortMalloc( xHstTaskSet.uxCount * sizeof( ReclaimGain_t ) );
+
+	if( pxGains == NULL )
+	{
+		uxGains = 0U;
+		return pdFAIL;
+	}
+
+	for( uxI = 0; uxI < xHstTaskSet.uxCount; uxI++ )
+	{
+		pxGains[ uxI ].xGain = 0U;
+		pxGains[ uxI ].xKey = 0U;
+		pxGains[ uxI ].xExpiry = 0U;
+	}
+
+	uxGains = xHstTaskSet.uxCount;
+
+	return pdPASS;
+}
+
+void vReclaimJobEnd( const HstTCB_t * pxTask, const TickType_t xKey, const TickType_t xExpiry )
+{
+	if( pxTask->uxIndex >= uxGains )
+	{
+		return;
+	}
+
+	ReclaimGain_t * const pxGain = &( pxGains[ pxTask->uxIndex ] );
+
+	/* The analysed wcet, not a declared one restored by a budget overrun. */
+	const TickType_t xWcet = xHstTaskSet.pxWcet[ pxTask->uxIndex ];
+
+	/* The tick does not change the gain meanwhile. */
+	taskENTER_CRITICAL();
+	{
+		pxGain->xGain = ( xWcet > pxTask->xCur ) ? xWcet - pxTask->xCur : 0U;
+		pxGain->xKey = xKey;
+		pxGain->xExpiry = xExpiry;
+
+		/* The selected gain was replaced (D > T): the HST selects again. */
+		if( uxCurrent == pxTask->uxIndex )
+		{
+			uxCurrent = reclaimNONE;
+		}
+	}
+	taskEXIT_CRITICAL();
+}
+
+BaseType_t xReclaimStart( const TickType_t xTc, const TickType_t xKey )
+{
+	UBaseType_t uxSelected = reclaimNONE;
+	UBaseType_t uxI;
+
+	for( uxI = 0; uxI < uxGains; uxI++ )
+	{
+		const ReclaimGain_t * const pxGain = &( pxGains[ uxI ] );
+
+		if( ( pxGain->xGain > 0U ) && ( pxGain->xKey <= xKey ) && ( pxGain->xExpiry > xTc ) )
+		{
+			if( ( uxSelected == reclaimNONE ) || ( pxGain->xExpiry < pxGains[ uxSelected ].xExpiry ) )
+			{
+				uxSelected = uxI;
+			}
+		}
+	}
+
+	taskENTER_CRITICAL();
+	{
+		uxCurrent = uxSelected;
+	}
+	taskEXIT_CRITICAL();
+
+	return ( uxSelected != reclaimNONE ) ? pdTRUE : pdFALSE;
+}
+
+TickType_t xReclaimGetAvailable( const TickType_t xTc )
+{
+	if( ( uxCurrent == reclaimNONE ) || ( pxGains[ uxCurrent ].xExpiry <= xTc ) )
+	{
+		return 0U;
+	}
+
+	const TickType_t xToExpiry = pxGains[ uxCurrent ].xExpiry - xTc;
+
+	return ( pxGains[ uxCurrent ].xGain < xToExpiry ) ? pxGains[ uxCurrent ].xGain : xToExpiry;
+}
+
+BaseType_t xReclaimTick( void )
+{
+	if( uxCurrent == reclaimNONE )
+	{
+		return pdFALSE;
+	}
+
+	ReclaimGain_t * const pxGain = &( pxGains[ uxCurrent ] );
+
+	if( pxGain->xGain == 0U )
+	{
+		uxCurrent = reclaimNONE;
+		return pdTRUE;
+	}
+
+	pxGain->xGain--;
+	ulReclaimed++;
+
+	if( ( pxGain->xGain == 0U ) || ( xTaskGetTickCountFromISR() >= pxGain->xExpiry ) )
+	{
+		/* Used up: the HST selects again. */
+		uxCurrent = reclaimNONE;
+		return pdTRUE;
+	}
+
+	return pdFALSE;
+}
+
+uint32_t ulReclaimGetReclaimed( void )
+{
+	return ulReclaimed;
+}
@@ -0,0 +1,75 @@
+#include "FreeRTOS.h"
+
+/**
+ * Gain-time reclaiming: the wcet a periodic job did not use, offered to the
+ * aperiodic work by the rm and edf policies (USE_RECLAIMING).
+ *
+ * The gain of a job can run in its place: at its urgency, the priority (rm)
+ * or absolute deadline (edf) of the job, and before its deadline. Any other
+ * job then meets the interference the analysis assumed, so the reclaimed
+ * time needs no new test. Under edf this passes the unused budget on in
+ * deadline order, as CASH does.
+ */
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * Allocates a gain per task of the task set (xHstTaskSet). Called by the
+ * policy from vSchedulerTaskSchedulerStartLogic().
+ *
+ * @return pdFAIL if there is not enough memory: nothing is reclaimed.
+ */
+BaseType_t xReclaimInit( void );
+
+/**
+ * Records the gain of the job of pxTask just finished, xWcet - xCur. The gain
+ * of its previous job is dropped, and no longer charged by the tick until
+ * the next xReclaimStart().
+ *
+ * @param pxTask
+ * @param xKey urgency of the job, its ready list value: lower is more urgent.
+ * @param xExpiry deadline of the job: the gain can not be used from then.
+ */
+void vReclaimJobEnd( const HstTCB_t * pxTask, const TickType_t xKey, const TickType_t xExpiry );
+
+/**
+ * Selects the gain to charge the next ticks to: among the gains at least as
+ * urgent as xKey and not expired at xTc, the one that expires first. The
+ * ticks are charged to it whatever runs, as the job that left it would have
+ * run: a gain kept for later could delay the jobs due before its deadline.
+ * O(n), from the HST only.
+ *
+ * @param xTc current time.
+ * @param xKey urgency of the first ready periodic job, portMAX_DELAY if none.
+ * @return pdTRUE if some gain was selected.
+ */
+BaseType_t xReclaimStart( const TickType_t xTc, const TickType_t xKey );
+
+/**
+ * Time left to the gain selected by xReclaimStart(): its ticks, up to its
+ * expiry.
+ *
+ * @param xTc current time.
+ * @return 0 if no gain is selected.
+ */
+TickType_t xReclaimGetAvailable( const TickType_t xTc );
+
+/**
+ * Charges one tick to the selected gain. Constant time: called from the
+ * tick hook.
+ *
+ * @return pdTRUE if the gain ran out or expired, to wake up the HST.
+ */
+BaseType_t xReclaimTick( void );
+
+/**
+ *
+ * @return ticks charged to the gains since the start.
+ */
+uint32_t ulReclaimGetReclaimed( void );
+
+#if defined (__cplusplus)
+}
+#endif
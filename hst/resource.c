@@ -0,0 +1,224 @@
+#include "FreeRTOS.h"
+#include "scheduler.h"
+#include "taskset.h"          // xHstTaskSet
+#include "resource.h"
+
+/* System ceiling when no resource is locked. */
+#define resourceNO_CEILING    ( ( UBaseType_t ) -1 )
+
+static UBaseType_t prvResourceLevel( const HstTCB_t * pxTask );
+
+/* Created resources. */
+static HstResource_t *pxResources = NULL;
+
+/* Locked resources, the last one first (SRP stack). */
+static HstResource_t *pxLocked = NULL;
+
+/* Highest ceiling of the locked resources: tasks at this index or below can
+ * not preempt. */
+static UBaseType_t uxSystemCeiling = resourceNO_CEILING;
+
+/* pdTRUE if pxResourceGate() kept a task from preempting. */
+static BaseType_t xPreemptionDeferred = pdFALSE;
+
+HstResource_t * pxResourceCreate( void )
+{
+	HstResource_t *pxResource = ( HstResource_t * ) pvPortMalloc( sizeof( HstResource_t ) );
+
+	if( pxResource != NULL )
+	{
+		pxResource->pxUses = NULL;
+		pxResource->uxCeiling = resourceNO_CEILING;
+		pxResource->uxPreviousCeiling = resourceNO_CEILING;
+		pxResource->pxOwner = NULL;
+		pxResource->pxPrevious = NULL;
+		pxResource->pxNext = pxResources;
+
+		pxResources = pxResource;
+	}
+
+	return pxResource;
+}
+
+BaseType_t xResourceUse( HstResource_t * pxResource, HstTCB_t * pxTask, TickType_t xCs )
+{
+	HstResourceUse_t *pxUse = ( HstResourceUse_t * ) pvPortMalloc( sizeof( HstResourceUse_t ) );
+
+	if( pxUse == NULL )
+	{
+		return pdFAIL;
+	}
+
+	pxUse->pxTask = pxTask;
+	pxUse->xCs = xCs;
+	pxUse->pxNext = pxResource->pxUses;
+
+	pxResource->pxUses = pxUse;
+
+	return pdPASS;
+}
+
+/**
+ * The blocking term of task i is the longest critical section of a lower
+ * level task on a resource with a ceiling at or above level i: under SRP a
+ * job is blocked at most once, before it starts.
+ */
+void vResourceSetup( void )
+{
+	TickType_t * const pxBlocking = xHstTaskSet.pxBlocking;
+	HstResource_t *pxResource;
+	HstResourceUse_t *pxUse;
+	UBaseType_t uxI;
+
+	for( uxI = 0; uxI < xHstTaskSet.uxCount; uxI++ )
+	{
+		pxBlocking[ uxI ] = 0;
+	}
+
+	for( pxResource = pxResources; pxResource != NULL; pxResource = pxResource->pxNext )
+	{
+		pxResource->uxCeiling = resourceNO_CEILING;
+
+		for( pxUse = pxResource->pxUses; pxUse != NULL; pxUse = pxUse->pxNext )
+		{
+			if( prvResourceLevel( pxUse->pxTask ) < pxResource->uxCeiling )
+			{
+				pxResource->uxCeiling = prvResourceLevel( pxUse->pxTask );
+			}
+		}
+
+		for( pxUse = pxResource->pxUses; pxUse != NULL; pxUse = pxUse->pxNext )
+		{
+			const UBaseType_t uxLevel = prvResourceLevel( pxUse->pxTask );
+
+			for( uxI = pxResource->uxCeiling; ( uxI < uxLevel ) && ( uxI < xHstTaskSet.uxCount ); uxI++ )
+			{
+				if( pxUse->xCs > pxBlocking[ uxI ] )
+				{
+					pxBlocking[ uxI ] = pxUse->xCs;
+				}
+			}
+		}
+	}
+}
+
+/**
+ * Same rule as vResourceSetup(), for one level. The ceilings are recomputed
+ * from the current task set order, without storing them.
+ */
+TickType_t xResourceBlocking( UBaseType_t uxLevel )
+{
+	TickType_t xBlocking = 0;
+	HstResource_t *pxResource;
+	HstResourceUse_t *pxUse;
+
+	for( pxResource = pxResources; pxResource != NULL; pxResource = pxResource->pxNext )
+	{
+		UBaseType_t uxCeiling = resourceNO_CEILING;
+
+		for( pxUse = pxResource->pxUses; pxUse != NULL; pxUse = pxUse->pxNext )
+		{
+			if( prvResourceLevel( pxUse->pxTask ) < uxCeiling )
+			{
+				uxCeiling = prvResourceLevel( pxUse->pxTask );
+			}
+		}
+
+		if( uxCeiling > uxLevel )
+		{
+			continue;
+		}
+
+		for( pxUse = pxResource->pxUses; pxUse != NULL; pxUse = pxUse->pxNext )
+		{
+			if( ( prvResourceLevel( pxUse->pxTask ) > uxLevel ) && ( pxUse->xCs > xBlocking ) )
+			{
+				xBlocking = pxUse->xCs;
+			}
+		}
+	}
+
+	return xBlocking;
+}
+
+void vResourceLock( HstResource_t * pxResource )
+{
+	vTaskSuspendAll();
+	{
+		pxResource->pxOwner = ( HstTCB_t * ) pvTaskGetThreadLocalStoragePointer( NULL, 0 );
+		pxResource->pxPrevious = pxLocked;
+		pxResource->uxPreviousCeiling = uxSystemCeiling;
+
+		if( pxResource->uxCeiling < uxSystemCeiling )
+		{
+			uxSystemCeiling = pxResource->uxCeiling;
+		}
+
+		pxLocked = pxResource;
+	}
+	xTaskResumeAll();
+}
+
+void vResourceUnlock( HstResource_t * pxResource )
+{
+	BaseType_t xWakeUp = pdFALSE;
+
+	vTaskSuspendAll();
+	{
+		configASSERT( pxLocked == pxResource );
+
+		uxSystemCeiling = pxResource->uxPreviousCeiling;
+		pxLocked = pxResource->pxPrevious;
+		pxResource->pxOwner = NULL;
+		pxResource->pxPrevious = NULL;
+
+		if( xPreemptionDeferred == pdTRUE )
+		{
+			/* A task waits for the ceiling to drop. */
+			xPreemptionDeferred = pdFALSE;
+			xWakeUp = pdTRUE;
+		}
+	}
+	xTaskResumeAll();
+
+	if( xWakeUp == pdTRUE )
+	{
+		vSchedulerWakeUp();
+	}
+}
+
+HstTCB_t * pxResourceGate( HstTCB_t * pxSelected )
+{
+	HstResource_t *pxResource;
+
+	if( ( pxLocked == NULL ) || ( pxSelected == NULL ) || ( prvResourceLevel( pxSelected ) < uxSystemCeiling ) )
+	{
+		return pxSelected;
+	}
+
+	for( pxResource = pxLocked; pxResource != NULL; pxResource = pxResource->pxPrevious )
+	{
+		if( pxResource->pxOwner == pxSelected )
+		{
+			return pxSelected;
+		}
+	}
+
+	xPreemptionDeferred = pdTRUE;
+
+	return pxLocked->pxOwner;
+}
+
+/**
+ * Preemption level of a task, as a task set index: periodic tasks by their
+ * position, aperiodic tasks below all of them.
+ */
+static UBaseType_t prvResourceLevel( const HstTCB_t * pxTask )
+{
+	if( pxTask->xHstTaskType == HST_PERIODIC )
+	{
+		return pxTask->uxIndex;
+	}
+
+	return xHstTaskSet.uxCount;
+}
@@ -0,0 +1,102 @@
+#include "FreeRTOS.h"
+
+/**
+ * A task that uses a resource, and its longest critical section on it.
+ */
+typedef struct HstResourceUse
+{
+	HstTCB_t *pxTask;
+	TickType_t xCs;                          /* Longest critical section, in ticks. */
+	struct HstResourceUse *pxNext;
+} HstResourceUse_t;
+
+/**
+ * Shared resource accessed under the Stack Resource Policy (SRP).
+ *
+ * Preemption levels follow the task set order (taskset.h): the task at index
+ * 0 has the highest level, and aperiodic tasks the lowest. The ceiling of a
+ * resource is the highest level of its users. While resources are locked a
+ * ready task may only preempt if its level is above the system ceiling, the
+ * highest ceiling of the locked resources. So a task never blocks on a
+ * resource: once it starts, every resource it may need is free.
+ *
+ * A task must not block or wait for its next period while it holds a
+ * resource.
+ */
+typedef struct HstResource
+{
+	HstResourceUse_t *pxUses;                /* Tasks that use the resource. */
+	UBaseType_t uxCeiling;                   /* Resource ceiling, a task set index. */
+	UBaseType_t uxPreviousCeiling;           /* System ceiling before the lock. */
+	HstTCB_t *pxOwner;                       /* Task holding the resource, NULL if free. */
+	struct HstResource *pxPrevious;          /* Resource locked before this one. */
+	struct HstResource *pxNext;              /* Next created resource. */
+} HstResource_t;
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * Create a resource. Call before vSchedulerInit().
+ *
+ * @return the resource, or NULL if it could not be allocated.
+ */
+HstResource_t * pxResourceCreate( void );
+
+/**
+ * Declare that pxTask uses pxResource, with critical sections up to xCs
+ * ticks. Call before vSchedulerInit().
+ *
+ * @param pxResource
+ * @param pxTask
+ * @param xCs longest critical section of pxTask on pxResource.
+ * @return pdFAIL if the declaration could not be allocated.
+ */
+BaseType_t xResourceUse( HstResource_t * pxResource, HstTCB_t * pxTask, TickType_t xCs );
+
+/**
+ * Computes the resource ceilings and the blocking term of each task
+ * (xHstTaskSet.pxBlocking). Called by vSchedulerInit(), after the task set
+ * was built and before the schedulability analysis.
+ */
+void vResourceSetup( void );
+
+/**
+ * Blocking term of the task at uxLevel with the current task set order. Only
+ * the tasks above and below the level matter, not their order, so it can be
+ * used while priorities are being assigned (xWcrtAssignPriorities()).
+ *
+ * @param uxLevel task set index.
+ * @return the longest critical section that can block the task at uxLevel.
+ */
+TickType_t xResourceBlocking( UBaseType_t uxLevel );
+
+/**
+ * Lock pxResource. Never blocks under SRP.
+ *
+ * @param pxResource
+ */
+void vResourceLock( HstResource_t * pxResource );
+
+/**
+ * Unlock pxResource, the last resource locked by the caller. Wakes up the HST
+ * if a task was kept from preempting by the system ceiling.
+ *
+ * @param pxResource
+ */
+void vResourceUnlock( HstResource_t * pxResource );
+
+/**
+ * Preemption test, called by the policies at the end of
+ * vSchedulerTaskSchedulerLogic().
+ *
+ * @param pxSelected task selected by the policy.
+ * @return pxSelected if its preemption level is above the system ceiling (or
+ * it holds a resource), otherwise the task that locked the last resource.
+ */
+HstTCB_t * pxResourceGate( HstTCB_t * pxSelected );
+
+#if defined (__cplusplus)
+}
+#endif
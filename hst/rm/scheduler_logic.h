@@ -1,2 +1,9 @@
 
 extern List_t * pxAllTasksList;
+
+/* Gain-time reclaiming (reclaim.h): the wcet the periodic jobs do not use
+ * runs the aperiodic tasks, at the priority of the job that left it. Without
+ * it the policy does not tell the aperiodic tasks apart. */
+#ifndef USE_RECLAIMING
+	#define USE_RECLAIMING 0
+#endif
@@ -1,17 +1,33 @@
 #include "FreeRTOS.h"
 #include "scheduler.h"
 #include "scheduler_logic.h"
+#include "resource.h"
+#if ( USE_RECLAIMING == 1 )
+#include "reclaim.h"
+#endif
 
 /* Ready tasks list. */
 List_t xReadyTasksList;
 List_t * pxReadyTasksList = NULL;
 List_t * pxAllTasksList = NULL;
 
+#if ( USE_RECLAIMING == 1 )
+/* Ready aperiodic list, by priority. */
+static List_t xAperiodicReadyTasksList;
+static List_t * pxAperiodicReadyTasksList = NULL;
+
+static HstTCB_t * prvReclaimSelect( HstTCB_t * pxPeriodic );
+static void prvSuspendAperiodicTasks( void );
+#endif
+
 /**
  * AppSchedLogic_Init()
  */
 void vSchedulerTaskSchedulerStartLogic( void )
 {
+#if ( USE_RECLAIMING == 1 )
+	( void ) xReclaimInit();
+#endif
 	return;
 }
 
@@ -20,7 +36,12 @@ void vSchedulerTaskSchedulerStartLogic( void )
  */
 BaseType_t vSchedulerTaskSchedulerTickLogic()
 {
+#if ( USE_RECLAIMING == 1 )
+	/* Wake up the HST when the reclaimed time runs out. */
+	return xReclaimTick();
+#else
 	return pdFALSE;
+#endif
 }
 
 /**
@@ -28,6 +49,15 @@ BaseType_t vSchedulerTaskSchedulerTickLogic()
  */
 void vSchedulerTaskSchedulerLogic( HstTCB_t **pxCurrentTask )
 {
+#if ( USE_RECLAIMING == 1 )
+	if( ( *pxCurrentTask != NULL ) && ( ( *pxCurrentTask )->xHstTaskType == HST_PERIODIC ) && ( ( *pxCurrentTask )->xState == HST_FINISHED ) )
+	{
+		/* The unused wcet of the job, at its priority until its deadline
+		 * (xRelease is the next release). */
+		vReclaimJobEnd( *pxCurrentTask, ( TickType_t ) ( *pxCurrentTask )->xPriority, ( *pxCurrentTask )->xRelease - ( *pxCurrentTask )->xPeriod + ( *pxCurrentTask )->xDeadline );
+	}
+#endif
+
 	*pxCurrentTask = NULL;
 
 	/* Select the first task in the ready list, if any. */
@@ -35,6 +65,13 @@ void vSchedulerTaskSchedulerLogic( HstTCB_t **pxCurrentTask )
 	{
 		*pxCurrentTask = ( HstTCB_t * ) listGET_OWNER_OF_HEAD_ENTRY( pxReadyTasksList );
 	}
+
+#if ( USE_RECLAIMING == 1 )
+	*pxCurrentTask = prvReclaimSelect( *pxCurrentTask );
+#endif
+
+	/* Stack Resource Policy: preempt only above the system ceiling. */
+	*pxCurrentTask = pxResourceGate( *pxCurrentTask );
 }
 
 /**
@@ -42,6 +79,22 @@ void vSchedulerTaskSchedulerLogic( HstTCB_t **pxCurrentTask )
  */
 void vSchedulerLogicAddTaskToReadyList( HstTCB_t *xTask )
 {
+#if ( USE_RECLAIMING == 1 )
+	if( xTask->xHstTaskType != HST_PERIODIC )
+	{
+		if( xTask->xState == HST_FINISHED )
+		{
+			/* A new aperiodic job, arrived now. */
+			xTask->xRelease = xTaskGetTickCountFromISR();
+			xTask->uxReleaseCount = xTask->uxReleaseCount + 1;
+			xTask->xCur = 0;
+		}
+
+		vListInsert( pxAperiodicReadyTasksList, &( xTask->xReadyListItem ) );
+		return;
+	}
+#endif
+
 	vListInsert( pxReadyTasksList, &( xTask->xReadyListItem ) );
 }
 
@@ -63,6 +116,15 @@ void vSchedulerLogicAddTask( HstTCB_t *pxTask )
 	listSET_LIST_ITEM_OWNER( &( pxTask->xReadyListItem ), pxTask );
 	listSET_LIST_ITEM_VALUE( &( pxTask->xReadyListItem ), pxTask->xPriority );
 
+#if ( USE_RECLAIMING == 1 )
+	if( pxTask->xPeriod == 0U )
+	{
+		/* Aperiodic task, its first job arrives at 0. */
+		vListInsert( pxAperiodicReadyTasksList, &( pxTask->xReadyListItem ) );
+		return;
+	}
+#endif
+
 	/* Add the task to the task list. */
 	vListInsert( pxReadyTasksList, &( pxTask->xReadyListItem ) );
 }
@@ -76,4 +138,65 @@ void vSchedulerLogicSetup( void )
 	vListInitialise( &( xReadyTasksList ) );
 	pxReadyTasksList = &( xReadyTasksList );
 	pxAllTasksList = &( xReadyTasksList );
+
+#if ( USE_RECLAIMING == 1 )
+	/* Initialize the aperiodic task ready list. */
+	vListInitialise( &( xAperiodicReadyTasksList ) );
+	pxAperiodicReadyTasksList = &( xAperiodicReadyTasksList );
+#endif
+}
+
+#if ( USE_RECLAIMING == 1 )
+/**
+ * Runs the first ready aperiodic task instead of pxPeriodic on the reclaimed
+ * time of a job of higher or the same priority, or in the background when no
+ * periodic task is ready. The optional step of pxPeriodic goes first.
+ */
+static HstTCB_t * prvReclaimSelect( HstTCB_t * pxPeriodic )
+{
+	const TickType_t xTc = xTaskGetTickCount();
+	const TickType_t xKey = ( pxPeriodic != NULL ) ? ( TickType_t ) pxPeriodic->xPriority : portMAX_DELAY;
+
+	/* The most urgent gain runs out whether an aperiodic task uses it or
+	 * not, as the job that left it would have run meanwhile. */
+	const BaseType_t xReclaiming = xReclaimStart( xTc, xKey );
+
+	/* Only the aperiodic task selected below is resumed. */
+	prvSuspendAperiodicTasks();
+
+	/* The optional step of the most urgent job starts if the gain fits it,
+	 * before the aperiodic tasks (imprecise computation). A granted step runs
+	 * to completion, at the urgency of the job. */
+	if( ( pxPeriodic != NULL ) && ( xSchedulerOptionalGrant( pxPeriodic, xReclaimGetAvailable( xTc ) ) == pdTRUE ) )
+	{
+		return pxPeriodic;
+	}
+
+	if( ( listLIST_IS_EMPTY( pxAperiodicReadyTasksList ) == pdFALSE ) && ( ( xReclaiming == pdTRUE ) || ( pxPeriodic == NULL ) ) )
+	{
+		return ( HstTCB_t * ) listGET_OWNER_OF_HEAD_ENTRY( pxAperiodicReadyTasksList );
+	}
+
+	return pxPeriodic;
+}
+
+/**
+ * Suspends the ready aperiodic tasks, as the HST does with the periodic ones.
+ */
+static void prvSuspendAperiodicTasks( void )
+{
+	ListItem_t * pxItem = listGET_HEAD_ENTRY( pxAperiodicReadyTasksList );
+
+	while( listGET_END_MARKER( pxAperiodicReadyTasksList ) != pxItem )
+	{
+		HstTCB_t * pxTask = ( HstTCB_t * ) listGET_LIST_ITEM_OWNER( pxItem );
+
+		if( eTaskGetState( pxTask->xHandle ) == eReady )
+		{
+			vTaskSuspend( pxTask->xHandle );
+		}
+
+		pxItem = listGET_NEXT( pxItem );
+	}
 }
+#endif
@@ -2,9 +2,27 @@
 #include "scheduler.h"
 #include "scheduler_logic.h"
 #include "wcrt.h"
+#include "taskset.h"
+#include "resource.h"
+#include "sensitivity.h"
+#include "adaptive.h"
+#if ( USE_QPA == 1 )
+#include "qpa.h"
+#endif
+#include "utils.h"
 #include "semphr.h"
 #include "queue.h"
 
+#if defined( configHST_TABLES_HEADER )
+/* Analysis precomputed offline by the task set compiler (tools/hstc). */
+#define HST_TABLES_DEFINE
+#include configHST_TABLES_HEADER
+
+#if ( HST_TABLE_USE_QPA != USE_QPA ) || ( HST_TABLE_USE_EXACT_WCRT != USE_EXACT_WCRT ) || ( HST_TABLE_USE_SLACK_STEALING != USE_SLACK_STEALING )
+	#error "configHST_TABLES_HEADER was generated for another policy (HST_SCHED)."
+#endif
+#endif
+
 #define ONE_TICK ( ( TickType_t ) 1 )
 
 #if ( configUSE_SCHEDULER_START_HOOK == 1 )
@@ -21,6 +39,17 @@ void vApplicationTickHook( void );
 /* HST function. */
 static void prvSchedulerTaskScheduler( void * params );
 
+/* Holds back the tasks with a release offset. */
+static void prvSchedulerDeferOffsetReleases( void );
+
+/* Copies the precomputed analysis to the task set. */
+static BaseType_t prvSchedulerLoadTables( void );
+
+#if ( configHST_OPTIMAL_PRIORITIES == 1 ) && ( USE_QPA != 1 ) && !defined( configHST_TABLES_HEADER )
+/* Copies the task set order to the task priorities. */
+static void prvSchedulerApplyPriorities( void );
+#endif
+
 /* Absolute deadlines. */
 static List_t xAbsDeadlinesList;
 
@@ -30,6 +59,26 @@ static TaskHandle_t xSchedulerTask = NULL;
 /* Current task. */
 static HstTCB_t *xCurrentTask = NULL;
 
+/* Tasks with a release offset, in offset order, and the next one to release. */
+static HstTCB_t **pxOffsetTasks = NULL;
+static UBaseType_t uxOffsetTasks = 0;
+static UBaseType_t uxNextOffset = 0;
+
+/* Offset tasks whose first release is due, counted by the tick hook. The HST
+ * adds the tasks [uxNextOffset, uxDueOffsets) to the ready lists. */
+static volatile UBaseType_t uxDueOffsets = 0;
+
+/* Precomputed analysis (vSchedulerSetTables()), NULL to analyse at boot. */
+#if defined( configHST_TABLES_HEADER )
+static const HstTableEntry_t *pxSchedulerTables = xHstTable;
+static UBaseType_t uxSchedulerTables = HST_TABLE_TASKS;
+static const HstTableOverheads_t *pxSchedulerTableOverheads = &xHstTableOverheads;
+#else
+static const HstTableEntry_t *pxSchedulerTables = NULL;
+static UBaseType_t uxSchedulerTables = 0;
+static const HstTableOverheads_t *pxSchedulerTableOverheads = NULL;
+#endif
+
 /**
  * AppSched_Init()
  */
@@ -38,14 +87,66 @@ void vSchedulerInit( void )
 	/* Create the scheduler task. */
 	xTaskCreate( prvSchedulerTaskScheduler, NULL, 256, NULL, TASK_SCHEDULER_PRIORITY, &xSchedulerTask );
 
-	/* Calculate the worst case response times for each task. */
-	xWcrtCalculateTasksWcrt();
+	/* Copy the task set parameters into contiguous arrays for the analysis. */
+	xTaskSetBuild( pxAllTasksList );
+
+#if ( configHST_OPTIMAL_PRIORITIES == 1 ) && ( USE_QPA != 1 ) && !defined( configHST_TABLES_HEADER )
+	/* Replace the priorities with an optimal assignment, if there is one. The
+	 * precomputed tables are in the application order. */
+	if( ( pxSchedulerTables == NULL ) && ( xWcrtAssignPriorities() == pdTRUE ) )
+	{
+		prvSchedulerApplyPriorities();
+	}
+	else
+	{
+		/* Keep the application priorities. */
+		xTaskSetBuild( pxAllTasksList );
+	}
+#endif
+
+	/* Resource ceilings and blocking terms, used by the analysis. */
+	vResourceSetup();
+
+#if !defined( configHST_TABLES_HEADER )
+	if( pxSchedulerTables == NULL )
+	{
+#if ( USE_QPA == 1 )
+		/* EDF schedulability analysis. */
+		xQpaCalculateTasksSchedulability();
+#else
+		/* Calculate the worst case response times for each task. */
+		xWcrtCalculateTasksWcrt();
+#endif
+
+#if ( configHST_SENSITIVITY == 1 )
+		/* Wcet headroom of each task, and the critical scaling factor. */
+		xSensitivityAnalyse();
+#endif
+	}
+	else
+#endif
+	{
+		/* The analysis was done offline or at compile time. The tables must
+		 * match the task set: generate them again after changing it. */
+		const BaseType_t xTables = prvSchedulerLoadTables();
+
+		configASSERT( xTables == pdTRUE );
+		( void ) xTables;
+	}
+
+#if ( configHST_ADAPTIVE_WCET == 1 )
+	/* Execution time windows, the wcets analysed above as the declared ones. */
+	( void ) xAdaptiveInit();
+#endif
 
 	/* Call the application scheduler hook function. This function should be
 	 * defined by the programmer of the application scheduler if needed.
 	 */
 	vSchedulerTaskSchedulerStartLogic();
 
+	/* The tasks with an offset are released by the tick hook. */
+	prvSchedulerDeferOffsetReleases();
+
 #if ( configUSE_SCHEDULER_START_HOOK == 1 )
 	/* Call the hook function. This function should be defined by the user. */
 	vSchedulerStartHook();
@@ -68,7 +169,7 @@ void vSchedulerSetup( void )
 /**
  * AppSched_TaskCreate()
  */
-BaseType_t xSchedulerTaskCreate( TaskFunction_t pxTaskCode, const char * const pcName, const uint16_t usStackDepth, void * const pvParameters, UBaseType_t uxPriority, HstTCB_t **pxCreatedTask, TickType_t xPeriod, TickType_t xDeadline, TickType_t xWcet )
+BaseType_t xSchedulerTaskCreateWithOffset( TaskFunction_t pxTaskCode, const char * const pcName, const uint16_t usStackDepth, void * const pvParameters, UBaseType_t uxPriority, HstTCB_t **pxCreatedTask, TickType_t xPeriod, TickType_t xDeadline, TickType_t xWcet, TickType_t xOffset )
 {
 	HstTCB_t *pxTaskHstTCB = ( HstTCB_t * ) pvPortMalloc( sizeof( HstTCB_t ) );
 
@@ -79,19 +180,36 @@ BaseType_t xSchedulerTaskCreate( TaskFunction_t pxTaskCode, const char * const p
 		/* Initialize the scheduler tasks TCBe members. */
 		pxTaskHstTCB->xPriority = uxPriority;
 		pxTaskHstTCB->xPeriod = xPeriod;
+		pxTaskHstTCB->ulPeriodRecip = 0;
 		pxTaskHstTCB->xDeadline = xDeadline;
-		pxTaskHstTCB->xAbsoluteDeadline = xDeadline;
-		pxTaskHstTCB->xRelease = 0;
+		pxTaskHstTCB->xAbsoluteDeadline = xOffset + xDeadline;
+		pxTaskHstTCB->xRelease = xOffset;
+		pxTaskHstTCB->xOffset = xOffset;
 		pxTaskHstTCB->xWcet = xWcet;
 		pxTaskHstTCB->xWcrt = 0;
+		pxTaskHstTCB->xWcetMax = 0;
+		pxTaskHstTCB->uxIndex = 0;
 		pxTaskHstTCB->uxReleaseCount = 0;
 		pxTaskHstTCB->xCur = 0;
+		pxTaskHstTCB->xOptional = 0;
+		pxTaskHstTCB->xOptionalCur = 0;
+		pxTaskHstTCB->xOptionalStep = 0;
+		pxTaskHstTCB->xOptionalLeft = 0;
+		pxTaskHstTCB->pvOptionalCutOff = NULL;
 		pxTaskHstTCB->xHstTaskType = HST_PERIODIC;
 		pxTaskHstTCB->xState = HST_READY;
 
 		if ( pxTaskHstTCB->xPeriod == 0 )
 		{
 			pxTaskHstTCB->xHstTaskType = HST_APERIODIC;
+			pxTaskHstTCB->xAbsoluteDeadline = 0;
+			pxTaskHstTCB->xRelease = 0;
+			pxTaskHstTCB->xOffset = 0;
+		}
+		else
+		{
+			/* The only division needed by the schedulability analysis. */
+			pxTaskHstTCB->ulPeriodRecip = ulUtilsReciprocal( pxTaskHstTCB->xPeriod );
 		}
 
 		/* Create the FreeRTOS task. */
@@ -133,11 +251,117 @@ BaseType_t xSchedulerTaskCreate( TaskFunction_t pxTaskCode, const char * const p
 }
 
 /**
+ * With D > T a job may complete after the release of the next one. Then
+ * vTaskDelayUntil() would not block, and the HST would see neither the end of
+ * this job nor the next release, so the job is finished here and the HST
+ * releases the next one without blocking the task.
+ *
  * AppSched_WaitForNextPeriod()
  */
 void vSchedulerWaitForNextPeriod()
 {
- 	vTaskDelayUntil( &( xCurrentTask->xRelease ), xCurrentTask->xPeriod );
+	BaseType_t xBacklogged = pdFALSE;
+
+	vTaskSuspendAll();
+	{
+		if( ( TickType_t ) ( xTaskGetTickCount() - xCurrentTask->xRelease ) >= xCurrentTask->xPeriod )
+		{
+			xCurrentTask->xRelease = xCurrentTask->xRelease + xCurrentTask->xPeriod;
+			xCurrentTask->xState = HST_FINISHED;
+			xTaskNotifyGive( xSchedulerTask );
+			xBacklogged = pdTRUE;
+		}
+	}
+	xTaskResumeAll();
+
+	if( xBacklogged == pdFALSE )
+	{
+		vTaskDelayUntil( &( xCurrentTask->xRelease ), xCurrentTask->xPeriod );
+	}
+}
+
+void vSchedulerWakeUp( void )
+{
+	xTaskNotifyGive( xSchedulerTask );
+}
+
+BaseType_t xSchedulerTaskSetOptional( HstTCB_t * pxTask, TickType_t xOptional, void ( *pvCutOff )( HstTCB_t * ) )
+{
+	if( pxTask->xHstTaskType != HST_PERIODIC )
+	{
+		return pdFAIL;
+	}
+
+	pxTask->xOptional = xOptional;
+	pxTask->pvOptionalCutOff = pvCutOff;
+
+	return pdPASS;
+}
+
+BaseType_t xSchedulerOptionalRun( TickType_t xStep )
+{
+	HstTCB_t * const pxTask = ( HstTCB_t * ) pvTaskGetThreadLocalStoragePointer( NULL, 0 );
+	BaseType_t xRun = pdFALSE;
+
+	/* The rest of the previous step is not carried over. */
+	pxTask->xOptionalLeft = 0;
+
+	if( ( xStep > 0U ) && ( ( pxTask->xOptionalCur + xStep ) <= pxTask->xOptional ) && ( ( xTaskGetTickCount() + xStep ) <= pxTask->xAbsoluteDeadline ) )
+	{
+		pxTask->xOptionalStep = xStep;
+
+		/* The HST preempts the task at once, and the policy grants the step
+		 * (xSchedulerOptionalGrant()) or selects another task. */
+		xTaskNotifyGive( xSchedulerTask );
+
+		xRun = ( pxTask->xOptionalLeft > 0U ) ? pdTRUE : pdFALSE;
+	}
+
+	if( ( xRun == pdFALSE ) && ( pxTask->pvOptionalCutOff != NULL ) )
+	{
+		pxTask->pvOptionalCutOff( pxTask );
+	}
+
+	return xRun;
+}
+
+BaseType_t xSchedulerOptionalGrant( HstTCB_t * pxTask, TickType_t xAvailable )
+{
+	if( pxTask->xOptionalLeft > 0U )
+	{
+		/* A step granted before runs to completion: its time was taken from
+		 * the slack or the gain then. */
+		return pdTRUE;
+	}
+
+	if( ( pxTask->xHstTaskType == HST_PERIODIC ) && ( pxTask->xState == HST_READY ) && ( pxTask->xOptionalStep > 0U ) && ( pxTask->xOptionalStep <= xAvailable ) )
+	{
+		/* A new step, granted only as a whole. */
+		pxTask->xOptionalLeft = pxTask->xOptionalStep;
+	}
+
+	pxTask->xOptionalStep = 0;
+
+	return ( pxTask->xOptionalLeft > 0U ) ? pdTRUE : pdFALSE;
+}
+
+TickType_t xSchedulerOptionalReserved( void )
+{
+	TickType_t xReserved = 0U;
+	UBaseType_t uxI;
+
+	for( uxI = 0; uxI < xHstTaskSet.uxCount; uxI++ )
+	{
+		const HstTCB_t * const pxTask = xHstTaskSet.pxTask[ uxI ];
+
+		/* A job that finished in a step does not run the rest. */
+		if( pxTask->xState != HST_FINISHED )
+		{
+			xReserved = xReserved + pxTask->xOptionalLeft;
+		}
+	}
+
+	return xReserved;
 }
 
 /**
@@ -149,19 +373,57 @@ void vSchedulerWaitForNextPeriod()
  */
 void vApplicationTickHook( void )
 {
+	traceHST_TICK_HOOK_ENTER();
+
+	BaseType_t xWakeUp = pdFALSE;
+
 	if( xCurrentTask != NULL )
 	{
-        /* Update execution time. */
-		xCurrentTask->xCur = xCurrentTask->xCur + ONE_TICK;
+		if( xCurrentTask->xOptionalLeft > 0U )
+		{
+			/* A step of the optional part, on the time granted by the
+			 * policy: not counted against xWcet. */
+			xCurrentTask->xOptionalCur = xCurrentTask->xOptionalCur + ONE_TICK;
+			xCurrentTask->xOptionalLeft = xCurrentTask->xOptionalLeft - ONE_TICK;
 
-        /* Verify for task overrun. */
-		if ( ( xCurrentTask->xWcet > 0 ) && ( xCurrentTask->xCur > xCurrentTask->xWcet) )
+			/* The step used up its time: the policy selects again. */
+			if( xCurrentTask->xOptionalLeft == 0U )
+			{
+				xWakeUp = pdTRUE;
+			}
+		}
+		else
 		{
-			vSchedulerWcetOverrunHook( xCurrentTask, xTaskGetTickCountFromISR() );
+			/* Update execution time. */
+			xCurrentTask->xCur = xCurrentTask->xCur + ONE_TICK;
+
+#if ( configHST_ADAPTIVE_WCET == 1 )
+			/* Past a budget below the declared wcet: the job goes on with the
+			 * declared one, and the HST reverts the other tasks. */
+			if( ( xCurrentTask->xWcet > 0 ) && ( xCurrentTask->xCur > xCurrentTask->xWcet ) && ( xAdaptiveOverrun( xCurrentTask ) == pdTRUE ) )
+			{
+				xWakeUp = pdTRUE;
+			}
+#endif
+
+			/* Verify for task overrun. */
+			if ( ( xCurrentTask->xWcet > 0 ) && ( xCurrentTask->xCur > xCurrentTask->xWcet) )
+			{
+				vSchedulerWcetOverrunHook( xCurrentTask, xTaskGetTickCountFromISR() );
+			}
 		}
 	}
 
 	const TickType_t xTickCount = xTaskGetTickCountFromISR();
+	BaseType_t xReleased = pdFALSE;
+
+	/* First release of the tasks with an offset. The HST may be walking the
+	 * policy lists, so only count them here: the HST adds them. */
+	while( ( uxDueOffsets < uxOffsetTasks ) && ( pxOffsetTasks[ uxDueOffsets ]->xOffset <= xTickCount ) )
+	{
+		uxDueOffsets++;
+		xReleased = pdTRUE;
+	}
 
 	/* Verify deadlines. */
 	if( listLIST_IS_EMPTY( &xAbsDeadlinesList ) == pdFALSE )
@@ -191,12 +453,187 @@ void vApplicationTickHook( void )
 	/* Returns pdTRUE if the application scheduler task must be awakened. */
 	BaseType_t result = vSchedulerTaskSchedulerTickLogic();
 
-	if( result == pdTRUE )
+	if( ( result == pdTRUE ) || ( xReleased == pdTRUE ) || ( xWakeUp == pdTRUE ) )
 	{
 		BaseType_t xHigherPriorityTaskWoken = pdFALSE;
 		vTaskNotifyGiveFromISR( xSchedulerTask, &xHigherPriorityTaskWoken );
 		portYIELD_FROM_ISR( xHigherPriorityTaskWoken );
 	}
+
+	traceHST_TICK_HOOK_EXIT();
+}
+
+void vSchedulerSetTables( const HstTableEntry_t * pxTable, UBaseType_t uxCount, const HstTableOverheads_t * pxOverheads )
+{
+	pxSchedulerTables = pxTable;
+	uxSchedulerTables = uxCount;
+	pxSchedulerTableOverheads = pxOverheads;
+}
+
+/**
+ * The tables hold the task parameters they were computed for, in task set
+ * order, so a stale header is detected here instead of being trusted.
+ *
+ * @return pdFALSE if the tables do not match the task set, or if it is not
+ * schedulable with the overheads.
+ */
+static BaseType_t prvSchedulerLoadTables( void )
+{
+	UBaseType_t uxI;
+
+	if( xHstTaskSet.uxCount != uxSchedulerTables )
+	{
+		return pdFALSE;
+	}
+
+	for( uxI = 0; uxI < xHstTaskSet.uxCount; uxI++ )
+	{
+		const HstTableEntry_t * pxEntry = &( pxSchedulerTables[ uxI ] );
+
+		if( ( pxEntry->xPeriod != xHstTaskSet.pxPeriod[ uxI ] ) || ( pxEntry->xDeadline != xHstTaskSet.pxDeadline[ uxI ] ) ||
+			( pxEntry->xWcet != xHstTaskSet.pxWcet[ uxI ] ) || ( pxEntry->xOffset != xHstTaskSet.pxOffset[ uxI ] ) ||
+			( pxEntry->xBlocking != xHstTaskSet.pxBlocking[ uxI ] ) )
+		{
+			return pdFALSE;
+		}
+	}
+
+	for( uxI = 0; uxI < xHstTaskSet.uxCount; uxI++ )
+	{
+		xHstTaskSet.pxWcrt[ uxI ] = pxSchedulerTables[ uxI ].xWcrt;
+		xHstTaskSet.pxTask[ uxI ]->xWcrt = pxSchedulerTables[ uxI ].xWcrt;
+		xHstTaskSet.pxTask[ uxI ]->xWcetMax = pxSchedulerTables[ uxI ].xWcetMax;
+	}
+
+	/* Tables computed with other overheads than the configured ones, e.g.
+	 * those of static_analysis.h, which ignore them, are not valid: the task
+	 * set is analysed again and the initial slacks are computed at boot. */
+	if( xWcrtSameOverheads( pxSchedulerTableOverheads->ulTickCycles, pxSchedulerTableOverheads->ulDispatchCycles,
+							pxSchedulerTableOverheads->ulPreemptionCycles, pxSchedulerTableOverheads->ulCpuClockHz ) == pdFALSE )
+	{
+		xHstTaskSet.pxTable = NULL;
+
+#if ( USE_QPA == 1 )
+		const BaseType_t xSchedulable = xQpaCalculateTasksSchedulability();
+#else
+		const BaseType_t xSchedulable = xWcrtCalculateTasksWcrt();
+#endif
+
+#if ( configHST_SENSITIVITY == 1 )
+		( void ) xSensitivityAnalyse();
+#else
+		for( uxI = 0; uxI < xHstTaskSet.uxCount; uxI++ )
+		{
+			xHstTaskSet.pxTask[ uxI ]->xWcetMax = 0;
+		}
+#endif
+
+		return xSchedulable;
+	}
+
+	xHstTaskSet.pxTable = pxSchedulerTables;
+
+	return pdTRUE;
+}
+
+#if ( configHST_OPTIMAL_PRIORITIES == 1 ) && ( USE_QPA != 1 ) && !defined( configHST_TABLES_HEADER )
+/**
+ * The priority of each periodic task becomes its task set index, and
+ * pxAllTasksList is sorted again by the item values, the priorities.
+ */
+static void prvSchedulerApplyPriorities( void )
+{
+	List_t xSorted;
+	UBaseType_t uxI;
+
+	for( uxI = 0; uxI < xHstTaskSet.uxCount; uxI++ )
+	{
+		xHstTaskSet.pxTask[ uxI ]->xPriority = uxI;
+	}
+
+	vListInitialise( &xSorted );
+
+	while( listLIST_IS_EMPTY( pxAllTasksList ) == pdFALSE )
+	{
+		ListItem_t *pxItem = listGET_HEAD_ENTRY( pxAllTasksList );
+		HstTCB_t *pxTask = ( HstTCB_t * ) listGET_LIST_ITEM_OWNER( pxItem );
+
+		uxListRemove( pxItem );
+
+		if( pxTask->xHstTaskType == HST_PERIODIC )
+		{
+			listSET_LIST_ITEM_VALUE( pxItem, pxTask->xPriority );
+		}
+
+		vListInsert( &xSorted, pxItem );
+	}
+
+	while( listLIST_IS_EMPTY( &xSorted ) == pdFALSE )
+	{
+		ListItem_t *pxItem = listGET_HEAD_ENTRY( &xSorted );
+
+		uxListRemove( pxItem );
+		vListInsertEnd( pxAllTasksList, pxItem );
+	}
+}
+#endif
+
+/**
+ * Takes the periodic tasks with a release offset out of the ready lists, so
+ * they are not executed until the HST releases them, at the tick counted by
+ * vApplicationTickHook(). Called
+ * after the policy start logic, which may compute per task state from the
+ * first release (e.g. the slack).
+ */
+static void prvSchedulerDeferOffsetReleases( void )
+{
+	UBaseType_t uxI, uxJ;
+
+	for( uxI = 0; uxI < xHstTaskSet.uxCount; uxI++ )
+	{
+		if( xHstTaskSet.pxTask[ uxI ]->xOffset > 0 )
+		{
+			uxOffsetTasks++;
+		}
+	}
+
+	if( uxOffsetTasks == 0 )
+	{
+		return;
+	}
+
+	pxOffsetTasks = ( HstTCB_t ** ) pvPortMalloc( uxOffsetTasks * sizeof( HstTCB_t * ) );
+
+	if( pxOffsetTasks == NULL )
+	{
+		/* Release every task at 0, as without offsets. */
+		uxOffsetTasks = 0;
+		return;
+	}
+
+	uxOffsetTasks = 0;
+
+	for( uxI = 0; uxI < xHstTaskSet.uxCount; uxI++ )
+	{
+		HstTCB_t *pxTask = xHstTaskSet.pxTask[ uxI ];
+
+		if( pxTask->xOffset > 0 )
+		{
+			/* Insertion sort, by offset. */
+			for( uxJ = uxOffsetTasks; ( uxJ > 0 ) && ( pxOffsetTasks[ uxJ - 1 ]->xOffset > pxTask->xOffset ); uxJ-- )
+			{
+				pxOffsetTasks[ uxJ ] = pxOffsetTasks[ uxJ - 1 ];
+			}
+
+			pxOffsetTasks[ uxJ ] = pxTask;
+			uxOffsetTasks++;
+
+			/* As a finished job, so the policy also drops its timers (e.g. the
+			 * dual priority promotion). */
+			pxTask->xState = HST_FINISHED;
+			vSchedulerLogicRemoveTaskFromReadyList( pxTask );
+		}
+	}
 }
 
 /**
@@ -208,6 +645,8 @@ static void prvSchedulerTaskScheduler( void* params )
 {
     do
     {
+		traceHST_SCHEDULER_ENTER();
+
 		vTaskSuspendAll();
 
 		if ( xCurrentTask != NULL )
@@ -233,12 +672,36 @@ static void prvSchedulerTaskScheduler( void* params )
 		    	if ( xCurrentTask->xHstTaskType == HST_PERIODIC )
 	        	{
 	        		uxListRemove( &( xCurrentTask->xAbsDeadlineListItem ) );
+
+#if ( configHST_ADAPTIVE_WCET == 1 )
+	        		/* Execution time of the job, for the wcet estimates. */
+	        		vAdaptiveJobEnd( xCurrentTask );
+#endif
 	        	}
 
 	        	vSchedulerLogicRemoveTaskFromReadyList( xCurrentTask );
+
+	        	/* The next release was already due, see
+	        	 * vSchedulerWaitForNextPeriod(). */
+	        	if( ( xCurrentTask->xHstTaskType == HST_PERIODIC ) && ( eTaskGetState( xCurrentTask->xHandle ) == eReady ) )
+	        	{
+	        		vSchedulerLogicAddTaskToReadyList( xCurrentTask );
+	        	}
 	        }
 		}
 
+		/* First release of the tasks with an offset, due since the tick
+		 * hook counted them. */
+		while( uxNextOffset < uxDueOffsets )
+		{
+			HstTCB_t *pxTask = pxOffsetTasks[ uxNextOffset ];
+
+			pxTask->xState = HST_READY;
+			vSchedulerLogicAddTaskToReadyList( pxTask );
+
+			uxNextOffset++;
+		}
+
 		ListItem_t * pxAppTasksListItem = listGET_HEAD_ENTRY( pxAllTasksList );
 
 		/* Suspend all ready tasks. */
@@ -262,6 +725,8 @@ static void prvSchedulerTaskScheduler( void* params )
 					pxAppTask->uxReleaseCount = pxAppTask->uxReleaseCount + 1;
 					pxAppTask->xState = HST_READY;
 					pxAppTask->xCur = 0;
+					pxAppTask->xOptionalCur = 0;
+					pxAppTask->xOptionalLeft = 0;
 
 					if ( pxAppTask->xHstTaskType == HST_PERIODIC )
 					{
@@ -278,9 +743,22 @@ static void prvSchedulerTaskScheduler( void* params )
 			pxAppTasksListItem = listGET_NEXT( pxAppTasksListItem );
 		}
 
+#if ( configHST_ADAPTIVE_WCET == 1 )
+		/* Budgets reverted after an overrun, or estimated again. */
+		vAdaptiveUpdate( xTaskGetTickCount() );
+#endif
+
+		HstTCB_t * const pxPreviousTask = xCurrentTask;
+
         /* Scheduler logic */
 		vSchedulerTaskSchedulerLogic( &xCurrentTask );
 
+		if( pxPreviousTask != NULL )
+		{
+			/* A request not granted by the policy is denied. */
+			pxPreviousTask->xOptionalStep = 0;
+		}
+
 		/* Resume the execution of the selected task. */
 		if ( xCurrentTask != NULL )
 		{
@@ -288,6 +766,8 @@ static void prvSchedulerTaskScheduler( void* params )
 			vTaskResume( xCurrentTask->xHandle );
 		}
 
+		traceHST_SCHEDULER_EXIT();
+
 		xTaskResumeAll();
 
         /* With pdTRUE this acts as a binary semaphore. */
@@ -377,6 +857,12 @@ extern void vSchedulerTaskReady( void* pxTask )
 
 	HstTCB_t *pxTaskInfo = ( HstTCB_t * ) pvTaskGetThreadLocalStoragePointer( pxTask, 0 );
 
+	/* Plain FreeRTOS tasks (e.g. the idle task) are not HST scheduled. */
+	if( pxTaskInfo == NULL )
+	{
+		return;
+	}
+
 	/* If task state is HST_READY, its execution was resumed by the HST with
 	 * an invocation of vTaskResume(). */
 	if( pxTaskInfo->xState == HST_READY )
@@ -3,6 +3,31 @@
 #define TASK_SCHEDULER_PRIORITY ( configMAX_PRIORITIES - 1 )
 #define TASK_PRIORITY 			( configMAX_PRIORITIES - 2 )
 
+/* HST instrumentation points, mapped by the benchmark (examples/bench). */
+#ifndef traceHST_SCHEDULER_ENTER
+	#define traceHST_SCHEDULER_ENTER()
+#endif
+
+#ifndef traceHST_SCHEDULER_EXIT
+	#define traceHST_SCHEDULER_EXIT()
+#endif
+
+#ifndef traceHST_TICK_HOOK_ENTER
+	#define traceHST_TICK_HOOK_ENTER()
+#endif
+
+#ifndef traceHST_TICK_HOOK_EXIT
+	#define traceHST_TICK_HOOK_EXIT()
+#endif
+
+#ifndef traceHST_SLACK_ENTER
+	#define traceHST_SLACK_ENTER()
+#endif
+
+#ifndef traceHST_SLACK_EXIT
+	#define traceHST_SLACK_EXIT()
+#endif
+
 /**
  *  Task types.
  */
@@ -40,19 +65,32 @@ struct HstTCB
 	// ----------------------
 	UBaseType_t xPriority;	      /* Priority. */
 	TickType_t xPeriod;		      /* Period. */
+	uint32_t ulPeriodRecip;       /* Reciprocal of xPeriod, for division-free analysis. */
 	TickType_t xDeadline;         /* Relative deadline. */
 	TickType_t xAbsoluteDeadline; /* Absolute deadline of the current release. */
 	TickType_t xRelease;	      /* Most recent task release absolute time. */
+	TickType_t xOffset;           /* Release time of the first job (phase). */
 
 	// ----------------------
 	TickType_t xWcet;		     /* Worst case execution time. */
 	TickType_t xWcrt;		     /* Worst case response time. */
+	TickType_t xWcetMax;	     /* Largest schedulable wcet, the others unchanged (sensitivity.h). */
+
+	// ----------------------
+	UBaseType_t uxIndex;         /* Position in the task set arrays (taskset.h). */
 
 	// ----------------------
 	UBaseType_t uxReleaseCount;  /* Release counter. */
 
 	// ----------------------
-	TickType_t xCur; 		     /* Current release tick count. */
+	TickType_t xCur; 		     /* Current release tick count, but for the optional part. */
+
+	// ----------------------
+	TickType_t xOptional;        /* Optional part wcet, 0 if none (imprecise computation). */
+	TickType_t xOptionalCur;     /* Ticks of the optional part run by the current release. */
+	TickType_t xOptionalStep;    /* Optional step requested by xSchedulerOptionalRun(). */
+	TickType_t xOptionalLeft;    /* Ticks left to the optional step granted by the policy. */
+	void ( *pvOptionalCutOff )( struct HstTCB * ); /* Called when the optional part is cut off. */
 
 	// ----------------------
 	HstTaskType_t xHstTaskType;  /* Task type. */
@@ -64,6 +102,36 @@ struct HstTCB
 
 typedef struct HstTCB HstTCB_t;
 
+/**
+ * Analysis of one periodic task, precomputed offline by the task set compiler
+ * (tools/hstc) or at compile time (static_analysis.h). The task parameters
+ * identify the task set it was computed for.
+ */
+typedef struct
+{
+	TickType_t xPeriod;
+	TickType_t xDeadline;
+	TickType_t xWcet;
+	TickType_t xOffset;
+	TickType_t xBlocking;       /* Blocking term (resource.h). */
+	TickType_t xWcrt;           /* Worst case response time. */
+	TickType_t xWcetMax;        /* Largest schedulable wcet (sensitivity.h). */
+	BaseType_t xSlack;          /* Slack at time 0 (ss). */
+	TickType_t xTtma;           /* End of the slack interval at time 0 (ss), 0 if the slack is not precomputed. */
+} HstTableEntry_t;
+
+/**
+ * Scheduling overheads a table was computed with (vWcrtSetOverheads()), all 0
+ * if the analysis ignored them.
+ */
+typedef struct
+{
+	uint32_t ulTickCycles;
+	uint32_t ulDispatchCycles;
+	uint32_t ulPreemptionCycles;
+	uint32_t ulCpuClockHz;      /* Clock the cycles were converted to ticks with, 0 without overheads. */
+} HstTableOverheads_t;
+
 #if defined (__cplusplus)
 extern "C" {
 #endif
@@ -102,20 +170,129 @@ void vSchedulerSetup( void );
 void vSchedulerInit( void );
 
 /**
- * Create a application scheduled task.
+ * Analysis results to use instead of analysing the task set at boot, in task
+ * set order (taskset.h). vSchedulerInit() checks that they were computed for
+ * the created tasks, and analyses the task set again if they were computed
+ * with other overheads than the configured ones. Call it before
+ * vSchedulerInit(), e.g. with the tables of static_analysis.h.
+ *
+ * @param pxTable results of each periodic task.
+ * @param uxCount number of entries of pxTable.
+ * @param pxOverheads overheads the results were computed with.
+ */
+void vSchedulerSetTables( const HstTableEntry_t * pxTable, UBaseType_t uxCount, const HstTableOverheads_t * pxOverheads );
+
+/**
+ * Create a application scheduled task, released for the first time at
+ * xOffset and then every xPeriod ticks.
+ */
+BaseType_t xSchedulerTaskCreateWithOffset( TaskFunction_t pxTaskCode, const char * const pcName, const uint16_t usStackDepth, void * const pvParameters, UBaseType_t uxPriority, HstTCB_t ** const pxCreatedTask, TickType_t xPeriod, TickType_t xDeadline, TickType_t xWcet, TickType_t xOffset );
+
+/**
+ * Create a application scheduled task, released for the first time at 0.
  */
-BaseType_t xSchedulerTaskCreate( TaskFunction_t pxTaskCode, const char * const pcName, const uint16_t usStackDepth, void * const pvParameters, UBaseType_t uxPriority, HstTCB_t ** const pxCreatedTask, TickType_t xPeriod, TickType_t xDeadline, TickType_t xWcet );
+#define xSchedulerTaskCreate( pxTaskCode, pcName, usStackDepth, pvParameters, uxPriority, pxCreatedTask, xPeriod, xDeadline, xWcet ) xSchedulerTaskCreateWithOffset( ( pxTaskCode ), ( pcName ), ( usStackDepth ), ( pvParameters ), ( uxPriority ), ( pxCreatedTask ), ( xPeriod ), ( xDeadline ), ( xWcet ), ( 0 ) )
 
 /**
  * Create a aperiodic application scheduled task.
  */
 #define xSchedulerAperiodicTaskCreate( pxTaskCode, pcName, usStackDepth, pvParameters, pxCreatedTask ) xSchedulerTaskCreate( ( pxTaskCode ), ( pcName ), ( usStackDepth ), ( pvParameters ), ( TASK_PRIORITY ), ( pxCreatedTask ), ( 0 ), ( 0 ), ( 0 ) )
 
+/**
+ * Create a aperiodic application scheduled task, served before the aperiodic
+ * tasks with a larger uxPriority value (0 is the most urgent).
+ */
+#define xSchedulerAperiodicTaskCreateWithPriority( pxTaskCode, pcName, usStackDepth, pvParameters, uxPriority, pxCreatedTask ) xSchedulerTaskCreate( ( pxTaskCode ), ( pcName ), ( usStackDepth ), ( pvParameters ), ( uxPriority ), ( pxCreatedTask ), ( 0 ), ( 0 ), ( 0 ) )
+
+/**
+ * Create a aperiodic application scheduled task, each job due xDeadline ticks
+ * after its arrival. Served in absolute deadline order by the policies that
+ * support it (ss, edl, APERIODIC_ORDER).
+ */
+#define xSchedulerAperiodicTaskCreateWithDeadline( pxTaskCode, pcName, usStackDepth, pvParameters, xDeadline, pxCreatedTask ) xSchedulerTaskCreate( ( pxTaskCode ), ( pcName ), ( usStackDepth ), ( pvParameters ), ( TASK_PRIORITY ), ( pxCreatedTask ), ( 0 ), ( xDeadline ), ( 0 ) )
+
+/* Order of the aperiodic service under slack stealing (ss, edl): by priority
+ * (xSchedulerAperiodicTaskCreateWithPriority(), in arrival order among equal
+ * priorities), or by absolute deadline
+ * (xSchedulerAperiodicTaskCreateWithDeadline(), the tasks without a deadline
+ * last). A more urgent arrival preempts the aperiodic task using the slack. */
+#define APERIODIC_BY_PRIORITY	0
+#define APERIODIC_BY_DEADLINE	1
+
+#ifndef APERIODIC_ORDER
+	#define APERIODIC_ORDER APERIODIC_BY_PRIORITY
+#endif
+
 /**
  * Suspend the caller task until its next period.
  */
 void vSchedulerWaitForNextPeriod( void );
 
+/**
+ * Imprecise computation: gives the periodic task pxTask an optional part of
+ * xOptional ticks per job, after its mandatory part. The analysis only takes
+ * xWcet, the mandatory part, into account: the optional part runs on the
+ * slack (ss, edl) or on the reclaimed time (rm and edf, USE_RECLAIMING), and
+ * never under the other policies. Call it before vSchedulerInit().
+ *
+ * @param pxTask
+ * @param xOptional optional part wcet.
+ * @param pvCutOff called from the task when its optional part is cut off,
+ * e.g. to keep the last refined result. May be NULL.
+ * @return pdFAIL if pxTask is not periodic.
+ */
+BaseType_t xSchedulerTaskSetOptional( HstTCB_t * pxTask, TickType_t xOptional, void ( *pvCutOff )( HstTCB_t * ) );
+
+/**
+ * Asks for the time to run the next step of the optional part of the job,
+ * of xStep ticks at most. The step runs if it fits the optional part left,
+ * ends before the job deadline, and the policy has the time for it now.
+ * Otherwise the optional part is cut off: the pvCutOff callback is called and
+ * the job should go on to vSchedulerWaitForNextPeriod(). E.g.
+ *
+ *   while( xSchedulerOptionalRun( STEP_WCET ) == pdTRUE ) { refine(); }
+ *
+ * A granted step runs to completion: preempted or blocked, it keeps the rest
+ * of its time, taken from the slack or the gain when it was granted, and its
+ * ticks are charged as optional whenever the task runs again. A step that
+ * runs past xStep goes on as mandatory work: it is counted in xCur, and
+ * reported by vSchedulerWcetOverrunHook() if the job then takes more than
+ * xWcet.
+ *
+ * @param xStep wcet of the step.
+ * @return pdTRUE if the step can run.
+ */
+BaseType_t xSchedulerOptionalRun( TickType_t xStep );
+
+/**
+ * Called by the policy with the time it can give now to the optional step of
+ * pxTask: grants the step requested by the task that was running, as a
+ * whole, if it fits in xAvailable. A step granted before goes on whatever
+ * xAvailable is.
+ *
+ * @param pxTask
+ * @param xAvailable slack or reclaimed time available, portMAX_DELAY in the
+ * background.
+ * @return pdTRUE if pxTask runs an optional step, the policy then charges the
+ * ticks as for an aperiodic task.
+ */
+BaseType_t xSchedulerOptionalGrant( HstTCB_t * pxTask, TickType_t xAvailable );
+
+/**
+ * Time granted to the optional steps and not run yet: the slack or the gain
+ * they took when granted, that ss and edl keep from the aperiodic tasks.
+ * O(n).
+ *
+ * @return
+ */
+TickType_t xSchedulerOptionalReserved( void );
+
+/**
+ * Wake up the HST, so it selects the task to execute again. Called from a
+ * task, e.g. when a resource is unlocked (resource.h).
+ */
+void vSchedulerWakeUp( void );
+
 
 /* --- AppSched_Logic -------------------------------------------------- */
 
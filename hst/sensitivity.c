@@ -0,0 +1,287 @@
+#include "FreeRTOS.h"
+#include "scheduler.h"
+#include "scheduler_logic.h"  // USE_QPA
+#include "taskset.h"          // xHstTaskSet
+#include "sensitivity.h"
+#include "wcrt.h"
+#if ( USE_QPA == 1 )
+#include "qpa.h"
+#endif
+
+/* Scaling factors and utilizations are Q16 fixed-point numbers: 1.0 is
+ * sensitivityONE. */
+#define sensitivityONE    ( ( uint64_t ) 0x10000 )
+
+static BaseType_t prvSensitivityTest( UBaseType_t uxFrom );
+static BaseType_t prvSensitivityCandidate( UBaseType_t uxFrom );
+static TickType_t prvSensitivityMaxWcet( UBaseType_t uxIndex, BaseType_t xSchedulable );
+static uint32_t prvSensitivityScaling( BaseType_t xSchedulable );
+static void prvSensitivityScale( uint32_t ulFactor );
+
+/* Critical scaling factor found by the last analysis. */
+static uint32_t ulScaling = 0U;
+
+/* Schedulability tests run by the last analysis. */
+static UBaseType_t uxProbes = 0;
+
+/* Q16 utilization of the task set, never above the real one. */
+static uint64_t ullUtilization = 0U;
+
+/**
+ * Schedulability is monotonic in the wcets, for the fixed priority and the
+ * EDF tests, so both results are found with a binary search over the test
+ * ("Sensitivity Analysis for Fixed-Priority Real-Time Systems", Bini, Di
+ * Natale, Buttazzo, use the same property). Each search starts from the
+ * nominal wcets, which pass when the task set is schedulable, and stops at
+ * the utilization and deadline limits, so it runs log2 of the remaining range
+ * tests, not one per tick of wcet.
+ *
+ * Under fixed priorities a larger wcet of task k does not change the response
+ * times of the tasks above it, so the tests of task k only analyse the tasks
+ * from k on (xWcrtCalculateTasksWcrtFrom()).
+ */
+BaseType_t xSensitivityAnalyse( void )
+{
+	const UBaseType_t uxCount = xHstTaskSet.uxCount;
+	BaseType_t xSchedulable;
+	UBaseType_t uxI;
+
+	uxProbes = 0;
+	ullUtilization = 0U;
+
+	for( uxI = 0; uxI < uxCount; uxI++ )
+	{
+		ullUtilization = ullUtilization + ( ( ( uint64_t ) xHstTaskSet.pxWcet[ uxI ] * xHstTaskSet.pulPeriodRecip[ uxI ] ) >> 16 );
+	}
+
+	xSchedulable = prvSensitivityTest( 0 );
+
+	for( uxI = 0; uxI < uxCount; uxI++ )
+	{
+		xHstTaskSet.pxTask[ uxI ]->xWcetMax = prvSensitivityMaxWcet( uxI, xSchedulable );
+	}
+
+	ulScaling = prvSensitivityScaling( xSchedulable );
+
+	/* The tests overwrote the response times. */
+	prvSensitivityScale( ( uint32_t ) sensitivityONE );
+	prvSensitivityTest( 0 );
+
+	return xSchedulable;
+}
+
+uint32_t ulSensitivityGetScaling( void )
+{
+	return ulScaling;
+}
+
+UBaseType_t uxSensitivityGetProbes( void )
+{
+	return uxProbes;
+}
+
+/**
+ * Schedulability test of the policy.
+ *
+ * @param uxFrom first task whose wcet changed since the last test that
+ * passed (fixed priorities only).
+ */
+static BaseType_t prvSensitivityTest( UBaseType_t uxFrom )
+{
+	uxProbes++;
+
+#if ( USE_QPA == 1 )
+	( void ) uxFrom;
+
+	return xQpaCalculateTasksSchedulability();
+#else
+	return xWcrtCalculateTasksWcrtFrom( uxFrom );
+#endif
+}
+
+/**
+ * Schedulability test of a candidate of the searches. The candidates with a
+ * utilization above 1 are rejected without analysing them: their busy
+ * periods never end. The utilization is summed in Q32, rounded down, so a
+ * candidate at exactly 1 still gets the policy test.
+ */
+static BaseType_t prvSensitivityCandidate( UBaseType_t uxFrom )
+{
+	const uint64_t ullOne = ( uint64_t ) 1U << 32;
+	uint64_t ullLo = 0U;
+	UBaseType_t uxI;
+
+	for( uxI = 0; uxI < xHstTaskSet.uxCount; uxI++ )
+	{
+		const TickType_t xC = xHstTaskSet.pxWcet[ uxI ];
+
+		/* C / T alone above 1 would overflow the sum. */
+		if( xC > xHstTaskSet.pxPeriod[ uxI ] )
+		{
+			return pdFALSE;
+		}
+
+		ullLo = ullLo + ( ( ( uint64_t ) xC << 32 ) / xHstTaskSet.pxPeriod[ uxI ] );
+
+		if( ullLo > ullOne )
+		{
+			return pdFALSE;
+		}
+	}
+
+	return prvSensitivityTest( uxFrom );
+}
+
+/**
+ * Largest wcet of a task keeping the task set schedulable. A job needs
+ * C + B <= D, and the utilization can not exceed 1, so C <= C_nominal +
+ * ( 1 - U ) * T.
+ */
+static TickType_t prvSensitivityMaxWcet( UBaseType_t uxIndex, BaseType_t xSchedulable )
+{
+	TickType_t * const pxWcet = xHstTaskSet.pxWcet;
+	const TickType_t xWcet = xHstTaskSet.pxTask[ uxIndex ]->xWcet;
+	const TickType_t xDeadline = xHstTaskSet.pxDeadline[ uxIndex ];
+	const TickType_t xBlocking = xHstTaskSet.pxBlocking[ uxIndex ];
+
+	/* Only tasks whose response times are still valid may be skipped. */
+	const UBaseType_t uxFrom = ( xSchedulable == pdTRUE ) ? uxIndex : 0;
+
+	TickType_t xLo = ( xSchedulable == pdTRUE ) ? xWcet : 0U;   // Passes (unless 0).
+	TickType_t xHi = ( xDeadline > xBlocking ) ? ( xDeadline - xBlocking ) : 0U;  // The largest candidate.
+	BaseType_t xProbed = pdFALSE;
+
+	if( ullUtilization <= sensitivityONE )
+	{
+		const uint64_t ullRoom = xWcet + ( ( ( sensitivityONE - ullUtilization ) * xHstTaskSet.pxPeriod[ uxIndex ] ) >> 16 );
+
+		if( ullRoom < xHi )
+		{
+			xHi = ( TickType_t ) ullRoom;
+		}
+	}
+	else if( xWcet < xHi )
+	{
+		xHi = xWcet;
+	}
+
+	if( xHi < xLo )
+	{
+		xHi = xLo;
+	}
+
+	while( xLo < xHi )
+	{
+		const TickType_t xMid = xLo + ( ( xHi - xLo + 1U ) >> 1 );
+
+		pxWcet[ uxIndex ] = xMid;
+		xProbed = pdTRUE;
+
+		if( prvSensitivityCandidate( uxFrom ) == pdTRUE )
+		{
+			xLo = xMid;
+		}
+		else
+		{
+			xHi = xMid - 1U;
+		}
+	}
+
+	pxWcet[ uxIndex ] = xWcet;
+
+#if ( USE_QPA != 1 )
+	if( ( xSchedulable == pdTRUE ) && ( xProbed == pdTRUE ) )
+	{
+		/* Restores the response times of task uxIndex on, for the next one. */
+		prvSensitivityTest( uxIndex );
+	}
+#else
+	( void ) xProbed;
+#endif
+
+	return xLo;
+}
+
+/**
+ * Critical scaling factor. Scaled by f, the utilization f * U can not
+ * exceed 1 and every job needs f * C + B <= D.
+ */
+static uint32_t prvSensitivityScaling( BaseType_t xSchedulable )
+{
+	const UBaseType_t uxCount = xHstTaskSet.uxCount;
+	uint64_t ullLo = ( xSchedulable == pdTRUE ) ? sensitivityONE : 0U;  // Passes (unless 0).
+	uint64_t ullHi = 0xFFFFFFFFULL;                                      // The largest candidate.
+	UBaseType_t uxI;
+
+	if( ullUtilization > 0U )
+	{
+		const uint64_t ullBound = ( sensitivityONE * sensitivityONE ) / ullUtilization;
+
+		if( ullBound < ullHi )
+		{
+			ullHi = ullBound;
+		}
+	}
+
+	for( uxI = 0; uxI < uxCount; uxI++ )
+	{
+		const TickType_t xWcet = xHstTaskSet.pxTask[ uxI ]->xWcet;
+		const TickType_t xRoom = ( xHstTaskSet.pxDeadline[ uxI ] > xHstTaskSet.pxBlocking[ uxI ] ) ? ( xHstTaskSet.pxDeadline[ uxI ] - xHstTaskSet.pxBlocking[ uxI ] ) : 0U;
+
+		if( xWcet > 0U )
+		{
+			const uint64_t ullBound = ( ( uint64_t ) xRoom * sensitivityONE ) / xWcet;
+
+			if( ullBound < ullHi )
+			{
+				ullHi = ullBound;
+			}
+		}
+	}
+
+	if( xSchedulable == pdFALSE )
+	{
+		if( ullHi >= sensitivityONE )
+		{
+			ullHi = sensitivityONE - 1U;
+		}
+	}
+	else if( ullHi < ullLo )
+	{
+		ullHi = ullLo;
+	}
+
+	while( ullLo < ullHi )
+	{
+		const uint64_t ullMid = ullLo + ( ( ullHi - ullLo + 1U ) >> 1 );
+
+		prvSensitivityScale( ( uint32_t ) ullMid );
+
+		if( prvSensitivityCandidate( 0 ) == pdTRUE )
+		{
+			ullLo = ullMid;
+		}
+		else
+		{
+			ullHi = ullMid - 1U;
+		}
+	}
+
+	return ( uint32_t ) ullLo;
+}
+
+/**
+ * Sets the wcet of every task to its nominal wcet times ulFactor (Q16),
+ * rounded up.
+ */
+static void prvSensitivityScale( uint32_t ulFactor )
+{
+	UBaseType_t uxI;
+
+	for( uxI = 0; uxI < xHstTaskSet.uxCount; uxI++ )
+	{
+		const uint64_t ullWcet = ( ( ( uint64_t ) xHstTaskSet.pxTask[ uxI ]->xWcet * ulFactor ) + sensitivityONE - 1U ) >> 16;
+
+		xHstTaskSet.pxWcet[ uxI ] = ( ullWcet < portMAX_DELAY ) ? ( TickType_t ) ullWcet : portMAX_DELAY;
+	}
+}
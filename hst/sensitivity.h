@@ -0,0 +1,46 @@
+#include "FreeRTOS.h"
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * Sensitivity analysis of the task set (xHstTaskSet), with the policy test
+ * (xWcrtCalculateTasksWcrt(), or xQpaCalculateTasksSchedulability() under
+ * EDF). Computes:
+ *
+ * - the xWcetMax of each task: the largest wcet that keeps the task set
+ *   schedulable, with the other wcets unchanged. 0 if no wcet does.
+ * - the critical scaling factor: the largest factor the wcets of every task
+ *   can be multiplied by (rounded up to whole ticks) keeping the task set
+ *   schedulable. Above 1.0 it is the available margin, below 1.0 the
+ *   reduction needed.
+ *
+ * Both keep the utilization below 1, so a task set at exactly 1 has no
+ * margin.
+ *
+ * Call it after the schedulability test, e.g. vSchedulerInit() does when
+ * configHST_SENSITIVITY is 1. It only uses the task set arrays and the
+ * HstTCB_t wcets, so it also runs offline, on the host. The response times
+ * are analysed again at the end.
+ *
+ * @return pdTRUE if the task set is schedulable.
+ */
+BaseType_t xSensitivityAnalyse( void );
+
+/**
+ *
+ * @return the critical scaling factor found by the last
+ * xSensitivityAnalyse(), Q16 fixed point (0x10000 is 1.0).
+ */
+uint32_t ulSensitivityGetScaling( void );
+
+/**
+ *
+ * @return schedulability tests run by the last xSensitivityAnalyse().
+ */
+UBaseType_t uxSensitivityGetProbes( void );
+
+#if defined (__cplusplus)
+}
+#endif
@@ -1,2 +1,37 @@
 
 extern List_t * pxAllTasksList;
+
+/* The policy uses the response times (wcrt.h). */
+#define USE_EXACT_WCRT 1
+
+/* The policy keeps slack counters (slack.h), also precomputed by the task set
+ * compiler (tools/hstc). */
+#define USE_SLACK_STEALING 1
+
+/* The aperiodic tasks are served in APERIODIC_ORDER (scheduler.h). */
+
+#if ( APERIODIC_ORDER == APERIODIC_BY_DEADLINE )
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * Submits a job of xWcet ticks, due xDeadline ticks from now, to the
+ * aperiodic task pxTask, suspended waiting for it (vTaskSuspend( NULL )). The
+ * job is accepted only if it and the accepted jobs complete by their
+ * deadlines within the slack available until then (xSlackGetSlackUntil()),
+ * less the slack granted to the optional steps: then the task is resumed,
+ * and its job guaranteed. The accepted jobs run before the optional steps,
+ * and a new step does not take their slack. Call from a task.
+ *
+ * @return pdTRUE if accepted, pdFALSE if rejected or pxTask is not waiting;
+ * a rejected job is not executed, and can take a degraded path.
+ */
+BaseType_t xSchedulerAperiodicJobSubmit( HstTCB_t * pxTask, const TickType_t xWcet, const TickType_t xDeadline );
+
+#if defined (__cplusplus)
+}
+#endif
+
+#endif
@@ -1,15 +1,26 @@
 #include "FreeRTOS.h"
 #include "scheduler.h"
 #include "scheduler_logic.h"
+#include "resource.h"
+#include "taskset.h"
 #include "slack.h"
 
 #define MIN_SLACK 0
-#define ONE_TICK ( ( TickType_t ) 1 )
 
 static BaseType_t xUsingSlack = pdFALSE;
 
+/* Slack granted to the optional steps not running, kept from the task using
+ * the slack: the HST selects again when the slack falls to it. */
+static BaseType_t xSlackReserved = 0;
+
 extern void vSchedulerNegativeSlackHook( TickType_t xTickCount, BaseType_t xSlack );
 
+static void prvSuspendAperiodicTasks( void );
+#if ( APERIODIC_ORDER == APERIODIC_BY_DEADLINE )
+static BaseType_t prvAperiodicGuarantee( const TickType_t xTc, const TickType_t xD, const TickType_t xWcet );
+static TickType_t prvAperiodicFirmDemand( void );
+#endif
+
 /* Periodic tasks list. */
 List_t xAllTasksList;
 List_t * pxAllTasksList = NULL;
@@ -39,6 +50,11 @@ void vSchedulerTaskSchedulerStartLogic( void )
 	vListInitialise( &( xAperiodicReadyTasksList ) );
 	pxAperiodicReadyTasksList = &( xAperiodicReadyTasksList );
 
+#if ( SLACK_METHOD == SLACK_TABLE )
+	/* Without a table the slack is computed at each job end. */
+	( void ) xSlackBuildTable();
+#endif
+
 	ListItem_t * pxAppTasksListItem = listGET_HEAD_ENTRY( pxAllTasksList );
 
 	/* Init periodic tasks. */
@@ -52,17 +68,30 @@ void vSchedulerTaskSchedulerStartLogic( void )
 
 		/* Initialize slack methods attributes. */
 		pxTaskInfoSlack->xDi = 0;
-		pxTaskInfoSlack->xSlack = 0;
 		pxTaskInfoSlack->xTtma = 0;
 		pxTaskInfoSlack->xK = 0;
+		pxTaskInfoSlack->xPending = pdFALSE;
 
 		pxAppTask->vExt = pxTaskInfoSlack;
 
-		vSlackCalculateSlack_fixed1( pxAppTask, 0 );
+		if( ( xHstTaskSet.pxTable != NULL ) && ( xHstTaskSet.pxTable[ pxAppTask->uxIndex ].xTtma != 0U ) )
+		{
+			/* Slack precomputed offline (tools/hstc). */
+			const HstTableEntry_t * pxEntry = &( xHstTaskSet.pxTable[ pxAppTask->uxIndex ] );
+
+			pxTaskInfoSlack->xDi = pxAppTask->xRelease + pxAppTask->xDeadline;
+			pxTaskInfoSlack->xTtma = pxEntry->xTtma;
+			xHstTaskSet.pxSlack[ pxAppTask->uxIndex ] = pxEntry->xSlack;
+		}
+		else
+		{
+			vSlackCalculateSlack_fixed1( pxAppTask, 0 );
+		}
 
-		pxTaskInfoSlack->xK = pxTaskInfoSlack->xSlack;
+		pxTaskInfoSlack->xK = xHstTaskSet.pxSlack[ pxAppTask->uxIndex ];
 
-		/* Insert the task into the ready list. */
+		/* Insert the task into the ready list, by its (final) priority. */
+		listSET_LIST_ITEM_VALUE( &( pxAppTask->xReadyListItem ), pxAppTask->xPriority );
 		vListInsert( pxReadyTasksList, &( pxAppTask->xReadyListItem ) );
 
 		pxAppTasksListItem = listGET_NEXT( pxAppTasksListItem );
@@ -70,17 +99,20 @@ void vSchedulerTaskSchedulerStartLogic( void )
 
 	pxAppTasksListItem = listGET_HEAD_ENTRY( pxAllAperiodicTasksList );
 
-	/* Init periodic tasks. */
+	/* Init aperiodic tasks. */
 	while( listGET_END_MARKER( pxAllAperiodicTasksList ) != pxAppTasksListItem )
 	{
-		/* Init aperiodic tasks. */
-		vSchedulerLogicAddTaskToReadyList( ( HstTCB_t * ) listGET_LIST_ITEM_OWNER( pxAppTasksListItem ) );
+		HstTCB_t * pxAppTask = ( HstTCB_t * ) listGET_LIST_ITEM_OWNER( pxAppTasksListItem );
+
+		/* The first job arrives at 0. */
+		pxAppTask->xAbsoluteDeadline = pxAppTask->xDeadline;
+		vSchedulerLogicAddTaskToReadyList( pxAppTask );
 
 		pxAppTasksListItem = listGET_NEXT( pxAppTasksListItem );
 	}
 
-	/* Minimal slack at the critical instant. */
-	vSlackUpdateAvailableSlack( &xAvailableSlack );
+	/* Minimal slack at the critical instant, no task running yet. */
+	vSlackSetLevel( xHstTaskSet.uxCount );
 }
 
 /**
@@ -91,41 +123,27 @@ BaseType_t vSchedulerTaskSchedulerTickLogic()
 	BaseType_t xResult = pdFALSE;
 
 	/* ==================   Update slack   ================== */
-	if( xUsingSlack == pdTRUE )
-	{
-		/* A NRTT is using Available Slack -- decrement all slack counters, and
-		 * increment the current aperiodic task executed time. */
-		vSlackDecrementAllTasksSlack( ONE_TICK );
-	}
-	else
-	{
-		if( listLIST_IS_EMPTY( pxReadyTasksList ) == pdFALSE )
-		{
-			/* A RTT is running -- decrement higher priority tasks slack, and
-			 * increment the current task executed time. */
-			HstTCB_t * pxTask = ( HstTCB_t * ) listGET_OWNER_OF_HEAD_ENTRY( pxReadyTasksList );
-			vSlackDecrementTasksSlack( pxTask , ONE_TICK );
-		}
-		else
-		{
-			/* The Idle task or a system scheduled task is running -- decrement
-			 * all slack counters. */
-			vSlackDecrementAllTasksSlack( ONE_TICK );
-		}
-	}
-
-	/* Update the xAvailableSlack global counter with the minimum slack. */
-	vSlackUpdateAvailableSlack( &xAvailableSlack );
+	/* Charge the tick to the tasks selected by the HST (vSlackSetLevel()),
+	 * and update the xAvailableSlack global counter with the minimum slack.
+	 * Constant time, whatever the number of tasks. */
+	vSlackTick();
 
 	if( xAvailableSlack < 0 )
 	{
 		vSchedulerNegativeSlackHook( xTaskGetTickCountFromISR(), xAvailableSlack );
 	}
 
+	/* The CPU is idle: wake up the scheduler to go on with the slack
+	 * computations in progress. */
+	if( ( xUsingSlack == pdFALSE ) && ( listLIST_IS_EMPTY( pxReadyTasksList ) != pdFALSE ) && ( uxSlackGetPending() > 0U ) )
+	{
+		xResult = pdTRUE;
+	}
+
 	/* If the system slack is below the minimum, wake up the scheduler. */
 	if( xUsingSlack == pdTRUE )
 	{
-		if( xAvailableSlack <= MIN_SLACK )
+		if( xAvailableSlack <= ( MIN_SLACK + xSlackReserved ) )
 		{
 			xResult = pdTRUE;
 		}
@@ -142,6 +160,14 @@ void vSchedulerTaskSchedulerLogic( HstTCB_t **pxCurrentTask )
 	/* Current RTOS tick value. */
 	const TickType_t xTickCount = xTaskGetTickCount();
 
+	traceHST_SLACK_ENTER();
+
+	/* Charge the ticks elapsed since the last call to the slack counters. */
+	vSlackSync();
+
+	/* Slack counters changed by this activation. */
+	BaseType_t xSlackChanged = ( uxSlackGetPending() > 0U ) ? pdTRUE : pdFALSE;
+
 	/* Check if the current release of the periodic task has finished. */
 	if( *pxCurrentTask != NULL )
 	{
@@ -149,60 +175,129 @@ void vSchedulerTaskSchedulerLogic( HstTCB_t **pxCurrentTask )
 		{
 			if( ( *pxCurrentTask )->xState == HST_FINISHED )
 			{
-#if ( USE_SLACK_K == 0 )
-				/* Recalculate slack. */
-				vSlackCalculateSlack_fixed1( *pxCurrentTask, xTickCount );
-#else
-				struct TaskInfo_Slack * pxTaskSlack = ( struct TaskInfo_Slack * ) ( *pxCurrentTask )->vExt;
-				pxTaskSlack->xSlack = pxTaskSlack->xK;
-#endif
+				/* Recalculate slack (SLACK_METHOD). */
+				vSlackJobEnd( *pxCurrentTask, xTickCount );
+
+				/* The wcet the counters were computed with: the task set one,
+				 * not a declared wcet restored by a budget overrun. */
+				const TickType_t xWcet = xHstTaskSet.pxWcet[ ( *pxCurrentTask )->uxIndex ];
 
-				if( ( *pxCurrentTask )->xWcet > ( *pxCurrentTask )->xCur )
+				if( xWcet > ( *pxCurrentTask )->xCur )
 				{
 					/* The release executed for less than the task worst case
 					 * execution time, so vSlackGainSlack() is called to assign
 					 * this time to lower priority tasks.
 					 */
-					vSlackGainSlack( *pxCurrentTask, ( ( *pxCurrentTask )->xWcet - ( *pxCurrentTask )->xCur ) );
+					vSlackGainSlack( *pxCurrentTask, ( xWcet - ( *pxCurrentTask )->xCur ) );
 				}
 
-				/* Update the available slack. */
-				vSlackUpdateAvailableSlack( &xAvailableSlack );
-
 				*pxCurrentTask = NULL;
+				xSlackChanged = pdTRUE;
 			}
 		}
 	}
 
+	if( xSlackChanged == pdTRUE )
+	{
+		/* A bounded share of the slack computations in progress, so the
+		 * HST latency does not depend on the periods. */
+		( void ) xSlackResumeSlack( SLACK_STEPS );
+
+		/* Update the available slack. */
+		vSlackUpdateAvailableSlack( &xAvailableSlack );
+	}
+
+	traceHST_SLACK_EXIT();
+
 	if( xAvailableSlack < 0 )
 	{
 		vSchedulerNegativeSlackHook( xTickCount, xAvailableSlack );
 	}
 
-	if( xAvailableSlack > MIN_SLACK )
+	/* The first periodic and aperiodic tasks in the ready lists, if any. */
+	HstTCB_t * const pxPeriodic = ( listLIST_IS_EMPTY( pxReadyTasksList ) == pdFALSE ) ? ( HstTCB_t * ) listGET_OWNER_OF_HEAD_ENTRY( pxReadyTasksList ) : NULL;
+	HstTCB_t * const pxAperiodic = ( listLIST_IS_EMPTY( pxAperiodicReadyTasksList ) == pdFALSE ) ? ( HstTCB_t * ) listGET_OWNER_OF_HEAD_ENTRY( pxAperiodicReadyTasksList ) : NULL;
+
+	/* The slack granted to the optional steps and not run yet. */
+	BaseType_t xReserved = ( BaseType_t ) xSchedulerOptionalReserved();
+
+	/* An accepted firm job, first in APERIODIC_BY_DEADLINE order. */
+	BaseType_t xFirm = pdFALSE;
+
+#if ( APERIODIC_ORDER == APERIODIC_BY_DEADLINE )
+	xFirm = ( ( pxAperiodic != NULL ) && ( pxAperiodic->xDeadline > 0U ) ) ? pdTRUE : pdFALSE;
+#endif
+
+	/* The optional step requested by the job that was running starts if the
+	 * slack fits it (imprecise computation). A granted step runs to
+	 * completion whatever the slack is then: it goes on, or resumes once its
+	 * job is the first ready one. */
+	HstTCB_t * pxOptional = NULL;
+
+	if( ( *pxCurrentTask != NULL ) && ( ( ( *pxCurrentTask )->xOptionalStep > 0U ) || ( ( *pxCurrentTask )->xOptionalLeft > 0U ) ) )
+	{
+		pxOptional = *pxCurrentTask;
+	}
+	else if( ( pxPeriodic != NULL ) && ( pxPeriodic->xOptionalLeft > 0U ) )
 	{
-		if( listLIST_IS_EMPTY( pxAperiodicReadyTasksList ) == pdFALSE )
+		pxOptional = pxPeriodic;
+	}
+
+	if( pxOptional != NULL )
+	{
+		const TickType_t xLeft = pxOptional->xOptionalLeft;
+
+		/* A new step only takes the slack neither reserved nor promised to
+		 * the accepted firm jobs. */
+		BaseType_t xFree = xAvailableSlack - xReserved - MIN_SLACK;
+
+#if ( APERIODIC_ORDER == APERIODIC_BY_DEADLINE )
+		if( ( xLeft == 0U ) && ( xFirm == pdTRUE ) )
 		{
-			if( xUsingSlack == pdFALSE )
-			{
-				/* Resume the execution of the first aperiodic task in the
-				 * ready list. */
-				*pxCurrentTask = ( HstTCB_t * ) listGET_OWNER_OF_HEAD_ENTRY( pxAperiodicReadyTasksList );
-				xUsingSlack = pdTRUE;
-			}
+			xFree = xFree - ( BaseType_t ) prvAperiodicFirmDemand();
+		}
+#endif
+
+		if( xSchedulerOptionalGrant( pxOptional, ( xFree > 0 ) ? ( TickType_t ) xFree : 0U ) == pdFALSE )
+		{
+			pxOptional = NULL;
 		}
 		else
 		{
-			xUsingSlack = pdFALSE;
+			xReserved = xReserved + ( BaseType_t ) ( pxOptional->xOptionalLeft - xLeft );
 		}
 	}
+
+	/* Only the aperiodic task selected below is resumed. */
+	prvSuspendAperiodicTasks();
+
+	if( ( xFirm == pdTRUE ) && ( ( xAvailableSlack - xReserved ) > MIN_SLACK ) )
+	{
+		/* Before the optional steps: the slack of the firm jobs was promised
+		 * when they were accepted (xSchedulerAperiodicJobSubmit()). */
+		*pxCurrentTask = pxAperiodic;
+		xUsingSlack = pdTRUE;
+		xSlackReserved = xReserved;
+	}
+	else if( pxOptional != NULL )
+	{
+		/* Before the other aperiodic tasks, charged as they are. */
+		*pxCurrentTask = pxOptional;
+		xUsingSlack = pdTRUE;
+		xSlackReserved = xReserved - ( BaseType_t ) pxOptional->xOptionalLeft;
+	}
+	else if( ( pxAperiodic != NULL ) && ( ( xAvailableSlack - xReserved ) > MIN_SLACK ) )
+	{
+		/* Resume the execution of the first aperiodic task in the ready list
+		 * (APERIODIC_ORDER), which preempts a less urgent one. The slack
+		 * is charged to every task whichever aperiodic task runs. */
+		*pxCurrentTask = pxAperiodic;
+		xUsingSlack = pdTRUE;
+		xSlackReserved = xReserved;
+	}
 	else
 	{
-		if( xUsingSlack == pdTRUE )
-		{
-			vTaskSuspend( ( *pxCurrentTask )->xHandle );
-			xUsingSlack = pdFALSE;
-		}
+		xUsingSlack = pdFALSE;
 	}
 
 	if( xUsingSlack == pdFALSE )
@@ -210,9 +305,25 @@ void vSchedulerTaskSchedulerLogic( HstTCB_t **pxCurrentTask )
 	    /* Resume the execution of the first task in the ready list, if any. */
 		if( listLIST_IS_EMPTY( pxReadyTasksList ) == pdFALSE )
 		{
-			*pxCurrentTask = ( HstTCB_t * ) listGET_OWNER_OF_HEAD_ENTRY( pxReadyTasksList );
+			*pxCurrentTask = pxPeriodic;
 		}
 	}
+
+	/* Stack Resource Policy: preempt only above the system ceiling. */
+	*pxCurrentTask = pxResourceGate( *pxCurrentTask );
+
+	if( ( xUsingSlack == pdFALSE ) && ( *pxCurrentTask != NULL ) && ( ( *pxCurrentTask )->xHstTaskType == HST_PERIODIC ) && ( ( *pxCurrentTask )->xOptionalLeft == 0U ) )
+	{
+		/* A RTT runs -- the next ticks decrement the slack of the higher
+		 * priority tasks. */
+		vSlackSetLevel( ( *pxCurrentTask )->uxIndex );
+	}
+	else
+	{
+		/* A NRTT or an optional step uses the available slack, or the Idle
+		 * task runs -- the next ticks decrement all slack counters. */
+		vSlackSetLevel( xHstTaskSet.uxCount );
+	}
 }
 
 /**
@@ -226,10 +337,45 @@ void vSchedulerLogicAddTaskToReadyList( HstTCB_t *xTask )
 	}
 	else
 	{
+		if( xTask->xState == HST_FINISHED )
+		{
+			/* A new aperiodic job, arrived now. */
+			xTask->xRelease = xTaskGetTickCountFromISR();
+			xTask->xAbsoluteDeadline = xTask->xRelease + xTask->xDeadline;
+			xTask->uxReleaseCount = xTask->uxReleaseCount + 1;
+			xTask->xCur = 0;
+		}
+
+#if ( APERIODIC_ORDER == APERIODIC_BY_DEADLINE )
+		/* Earliest absolute deadline first, the tasks without one last. */
+		listSET_LIST_ITEM_VALUE( &( xTask->xReadyListItem ), ( xTask->xDeadline > 0U ) ? xTask->xAbsoluteDeadline : portMAX_DELAY );
+#endif
+
 		vListInsert( pxAperiodicReadyTasksList, &( xTask->xReadyListItem ) );
 	}
 }
 
+/**
+ * Suspends the ready aperiodic tasks, as the HST does with the periodic ones:
+ * a task that arrives or is preempted does not run until selected again.
+ */
+static void prvSuspendAperiodicTasks( void )
+{
+	ListItem_t * pxItem = listGET_HEAD_ENTRY( pxAperiodicReadyTasksList );
+
+	while( listGET_END_MARKER( pxAperiodicReadyTasksList ) != pxItem )
+	{
+		HstTCB_t * pxTask = ( HstTCB_t * ) listGET_LIST_ITEM_OWNER( pxItem );
+
+		if( eTaskGetState( pxTask->xHandle ) == eReady )
+		{
+			vTaskSuspend( pxTask->xHandle );
+		}
+
+		pxItem = listGET_NEXT( pxItem );
+	}
+}
+
 /**
  * Remove xTask from the ready task list.
  */
@@ -279,3 +425,123 @@ void vSchedulerLogicSetup( void )
 	vListInitialise( &( xAllAperiodicTasksList ) );
 	pxAllAperiodicTasksList = &( xAllAperiodicTasksList );
 }
+
+#if ( APERIODIC_ORDER == APERIODIC_BY_DEADLINE )
+BaseType_t xSchedulerAperiodicJobSubmit( HstTCB_t * pxTask, const TickType_t xWcet, const TickType_t xDeadline )
+{
+	BaseType_t xAccepted = pdFALSE;
+
+	/* The slack counters and the ready list do not change meanwhile. */
+	vTaskSuspendAll();
+	{
+		const TickType_t xTc = xTaskGetTickCount();
+
+		/* The task finished its previous job, and waits for the next one. */
+		if( ( pxTask->xHstTaskType == HST_APERIODIC ) && ( xDeadline > 0U ) && ( pxTask->xState == HST_FINISHED ) &&
+			( listIS_CONTAINED_WITHIN( pxAperiodicReadyTasksList, &( pxTask->xReadyListItem ) ) == pdFALSE ) &&
+			( eTaskGetState( pxTask->xHandle ) == eSuspended ) )
+		{
+			xAccepted = prvAperiodicGuarantee( xTc, xTc + xDeadline, xWcet );
+		}
+
+		if( xAccepted == pdTRUE )
+		{
+			/* The arrival sets the absolute deadline, see
+			 * vSchedulerLogicAddTaskToReadyList(). An overrun of xWcet calls
+			 * vSchedulerWcetOverrunHook(). */
+			pxTask->xWcet = xWcet;
+			pxTask->xDeadline = xDeadline;
+			vTaskResume( pxTask->xHandle );
+		}
+	}
+	xTaskResumeAll();
+
+	return xAccepted;
+}
+
+/**
+ * Guarantee test of a job of xWcet ticks due at xD. The firm jobs run in
+ * deadline order before the jobs without a deadline, so the new job, and
+ * each accepted job due after it, must complete the accepted work due up to
+ * its deadline, and the new job, within the slack available until then.
+ * O(n), plus constant time per accepted job.
+ */
+static BaseType_t prvAperiodicGuarantee( const TickType_t xTc, const TickType_t xD, const TickType_t xWcet )
+{
+	ListItem_t * pxItem = listGET_HEAD_ENTRY( pxAperiodicReadyTasksList );
+	BaseType_t xChecked = pdFALSE;
+
+	/* The slack granted to the optional steps is not available. */
+	TickType_t xDemand = xWcet + xSchedulerOptionalReserved();
+
+	while( listGET_END_MARKER( pxAperiodicReadyTasksList ) != pxItem )
+	{
+		const HstTCB_t * pxJob = ( HstTCB_t * ) listGET_LIST_ITEM_OWNER( pxItem );
+		const TickType_t xDue = listGET_LIST_ITEM_VALUE( pxItem );
+
+		if( pxJob->xDeadline == 0U )
+		{
+			/* Jobs without a deadline, served last. */
+			break;
+		}
+
+		if( ( xChecked == pdFALSE ) && ( xDue > xD ) )
+		{
+			if( ( BaseType_t ) xDemand > xSlackGetSlackUntil( xTc, xD ) )
+			{
+				return pdFALSE;
+			}
+
+			xChecked = pdTRUE;
+		}
+
+		if( pxJob->xWcet > pxJob->xCur )
+		{
+			xDemand = xDemand + ( pxJob->xWcet - pxJob->xCur );
+		}
+
+		if( ( xChecked == pdTRUE ) && ( ( BaseType_t ) xDemand > xSlackGetSlackUntil( xTc, xDue ) ) )
+		{
+			return pdFALSE;
+		}
+
+		pxItem = listGET_NEXT( pxItem );
+	}
+
+	if( ( xChecked == pdFALSE ) && ( ( BaseType_t ) xDemand > xSlackGetSlackUntil( xTc, xD ) ) )
+	{
+		return pdFALSE;
+	}
+
+	return pdTRUE;
+}
+
+/**
+ * Work left to the accepted firm jobs, at the head of the ready list. O(n)
+ * in the firm jobs.
+ */
+static TickType_t prvAperiodicFirmDemand( void )
+{
+	ListItem_t * pxItem = listGET_HEAD_ENTRY( pxAperiodicReadyTasksList );
+	TickType_t xDemand = 0U;
+
+	while( listGET_END_MARKER( pxAperiodicReadyTasksList ) != pxItem )
+	{
+		const HstTCB_t * pxJob = ( HstTCB_t * ) listGET_LIST_ITEM_OWNER( pxItem );
+
+		if( pxJob->xDeadline == 0U )
+		{
+			break;
+		}
+
+		if( pxJob->xWcet > pxJob->xCur )
+		{
+			xDemand = xDemand + ( pxJob->xWcet - pxJob->xCur );
+		}
+
+		pxItem = listGET_NEXT( pxItem );
+	}
+
+	return xDemand;
+}
+#endif
@@ -1,37 +1,175 @@
 #include "FreeRTOS.h"
 #include "scheduler.h"
-#include "scheduler_logic.h" // pxBigTaskList
+#include "taskset.h"
 #include "slack.h"
+#include "wcrt.h"
 #include "utils.h"
 
-static inline TickType_t xSlackGetWorkLoad( HstTCB_t * pxTask, const TickType_t xTc );
-static inline BaseType_t prvSlackCalcSlack( HstTCB_t * pxTask, const TickType_t xTc, const TickType_t xT, const TickType_t xWc );
+static inline TickType_t xSlackGetWorkLoad( const UBaseType_t uxIndex, const TickType_t xTc, uint32_t * const pulReleased );
+static inline BaseType_t prvSlackCalcSlack( const UBaseType_t uxIndex, const TickType_t xTc, const TickType_t xT, const TickType_t xWc, const uint32_t ulReleased );
 
 BaseType_t xAvailableSlack = 0;
 
-void vSlackCalculateSlack_fixed1( HstTCB_t * pxTask, const TickType_t xTc )
+/* Marks an empty range of tasks in the minima below. */
+#define slackNO_TASKS ( ( BaseType_t ) ( ( ~( UBaseType_t ) 0U ) >> 1U ) )
+
+/* Lazy accounting of the slack counters: the tick only counts the ticks to
+ * charge, the counters are brought up to date by vSlackSync(). The ticks in
+ * xSlackPendingLevel are charged to the tasks [0, uxSlackLevel), the ones in
+ * xSlackPendingAll to every task. */
+static UBaseType_t uxSlackLevel = 0U;
+static TickType_t xSlackPendingLevel = 0U;
+static TickType_t xSlackPendingAll = 0U;
+
+/* Minimum slack of the tasks [0, uxSlackLevel) and [uxSlackLevel, uxCount),
+ * with the pending ticks charged. */
+static BaseType_t xSlackMinAbove = 0;
+static BaseType_t xSlackMinBelow = 0;
+
+/* Slack computations in progress (vSlackStartSlack()). */
+static UBaseType_t uxSlackPending = 0U;
+
+/* Slack of the jobs of a task over a hyperperiod (xSlackBuildTable()): the
+ * slack at the end of the job before the job of entry e, if it ended at its
+ * release, less the workload completed from the start. Stored as its first
+ * value and the differences between consecutive jobs. The hyperperiod starts
+ * after the offsets, so the next ones repeat it. */
+typedef struct SlackTable
+{
+	uint32_t ulDelta;			/* In pxSlackDeltas, entry e minus entry e - 1 for e in [1, uxJobs). */
+	BaseType_t xFirst;
+	TickType_t xDemand;			/* Workload of the tasks [0, uxIndex] in a hyperperiod. */
+	TickType_t xWcet;			/* Wcet of the task the table was built with. */
+	UBaseType_t uxJobs;			/* Jobs of the task in a hyperperiod. */
+	uint32_t ulJobsRecip;
+	uint32_t ulFirstJob;		/* Job of entry 0. */
+	UBaseType_t uxCursor;		/* Last entry looked up, and */
+	BaseType_t xCursor;			/* its value. */
+} SlackTable_t;
+
+static SlackTable_t * pxSlackTable = NULL;
+static int16_t * pxSlackDeltas = NULL;
+static size_t xSlackTableSize = 0U;
+
+/* pdTRUE while the wcets differ from the ones of the table (adaptive.h). */
+static BaseType_t xSlackTableStale = pdFALSE;
+
+/* pdTRUE from vSlackRecalculate() to the next vSlackSetLevel(): the counters
+ * already count the jobs finished by then. */
+static BaseType_t xSlackRecalculated = pdFALSE;
+
+/**
+ * First release of the task at uxIndex at or after xT.
+ */
+static inline TickType_t prvSlackFirstRelease( const UBaseType_t uxIndex, const TickType_t xT )
 {
-	ListItem_t const *pxTaskListEndItem = listGET_END_MARKER( pxAllTasksList );  // end marker
-    ListItem_t *pxTaskListItem = &( pxTask->xGenericListItem );		            // this task list item
-    ListItem_t *pxHigherPrioTaskListItem = pxTaskListItem->pxPrevious;	        // higher priority task item
+	const TickType_t xPeriod = xHstTaskSet.pxPeriod[ uxIndex ];
+	const TickType_t xOffset = xHstTaskSet.pxOffset[ uxIndex ];
 
-    TaskSs_t* pxTaskSlack = ( TaskSs_t* ) pxTask->vExt;
+	if( xT > xOffset )
+	{
+		return xOffset + ( U_CEIL_R( xT - xOffset, xPeriod, xHstTaskSet.pulPeriodRecip[ uxIndex ] ) * xPeriod );
+	}
 
-    TickType_t xXi = ( TickType_t ) 0U;
-    TickType_t xDi = pxTask->xDeadline;
+	return xOffset;
+}
 
-    if ( xTc > ( TickType_t ) 0U )
-    {
-    	xXi = pxTask->xRelease;
-    	xDi = xXi + pxTask->xDeadline;
-    }
+static inline void prvSlackSetPending( TaskSs_t * const pxTaskSlack, const BaseType_t xPending )
+{
+	if( pxTaskSlack->xPending != xPending )
+	{
+		if( xPending == pdFALSE )
+		{
+			uxSlackPending--;
+		}
+		else
+		{
+			uxSlackPending++;
+		}
+
+		pxTaskSlack->xPending = xPending;
+	}
+}
+
+/**
+ * Raises the slack counter of the task at uxIndex to the slack found so far,
+ * less the ticks charged and plus the slack gained since the computation
+ * started. Both the counter and that value never exceed the slack the full
+ * computation would have set, so the larger one is kept.
+ */
+static inline void prvSlackRaise( const UBaseType_t uxIndex )
+{
+	const TaskSs_t * const pxTaskSlack = ( TaskSs_t * ) xHstTaskSet.pxTask[ uxIndex ]->vExt;
+	const BaseType_t xSlack = pxTaskSlack->xKmax - ( BaseType_t ) xHstTaskSet.pxBlocking[ uxIndex ] - pxTaskSlack->xCharged;
+
+	if( xSlack > xHstTaskSet.pxSlack[ uxIndex ] )
+	{
+		xHstTaskSet.pxSlack[ uxIndex ] = xSlack;
+	}
+}
+
+/**
+ * One step of the slack computation of the task at uxIndex: checks the next
+ * release point of a higher priority task in [xIntervalo, xDi), or completes
+ * the computation when none is left. O(n), whatever the periods.
+ */
+static void prvSlackStep( const UBaseType_t uxIndex )
+{
+	TaskSs_t * const pxTaskSlack = ( TaskSs_t * ) xHstTaskSet.pxTask[ uxIndex ]->vExt;
+
+	// Skip the higher priority tasks without release points left
+	while( pxTaskSlack->xNext >= pxTaskSlack->xDi )
+	{
+		if( pxTaskSlack->uxHigher == 0U )
+		{
+			prvSlackRaise( uxIndex );
+			pxTaskSlack->xTtma = pxTaskSlack->xTmax;
+			prvSlackSetPending( pxTaskSlack, pdFALSE );
+			return;
+		}
+
+		pxTaskSlack->uxHigher--;
+		pxTaskSlack->xNext = prvSlackFirstRelease( pxTaskSlack->uxHigher, pxTaskSlack->xIntervalo );
+	}
+
+	const TickType_t xii = pxTaskSlack->xNext;
+	const BaseType_t xK2 = prvSlackCalcSlack( uxIndex, pxTaskSlack->xTc, xii, pxTaskSlack->xWc, pxTaskSlack->ulReleased );
+
+	if( xK2 > pxTaskSlack->xKmax )
+	{
+		pxTaskSlack->xKmax = xK2;
+		pxTaskSlack->xTmax = xii;
+		prvSlackRaise( uxIndex );
+	}
+	else if( ( xK2 == pxTaskSlack->xKmax ) && ( xii < pxTaskSlack->xTmax ) )
+	{
+		pxTaskSlack->xTmax = xii;
+	}
+
+	pxTaskSlack->xNext = xii + xHstTaskSet.pxPeriod[ pxTaskSlack->uxHigher ];
+}
+
+void vSlackStartSlack( HstTCB_t * pxTask, const TickType_t xTc )
+{
+	const UBaseType_t uxIndex = pxTask->uxIndex;                                // this task index
+	BaseType_t * const pxSlack = xHstTaskSet.pxSlack;
+	const TickType_t * const pxBlocking = xHstTaskSet.pxBlocking;
+
+    TaskSs_t* pxTaskSlack = ( TaskSs_t* ) pxTask->vExt;
+
+    // Next release, the release offset at the start
+    TickType_t xXi = pxTask->xRelease;
+    TickType_t xDi = xXi + pxTask->xDeadline;
 
     pxTaskSlack->xDi = xDi;
 
+    // A new job end discards the computation in progress, if any
+    prvSlackSetPending( pxTaskSlack, pdFALSE );
+
     // if xTask is the highest priority task
-    if( pxTaskListEndItem == pxHigherPrioTaskListItem )
+    if( uxIndex == 0 )
     {
-    	pxTaskSlack->xSlack = xDi - xTc - pxTask->xWcet;
+    	pxSlack[ uxIndex ] = xDi - xTc - pxTask->xWcet - pxBlocking[ uxIndex ] - xWcrtGetOverhead( xDi - xTc, 1U, 0U );
     	pxTaskSlack->xTtma = xDi;
     	return;
     }
@@ -39,33 +177,46 @@ void vSlackCalculateSlack_fixed1( HstTCB_t * pxTask, const TickType_t xTc )
     BaseType_t xKmax = 0U;
     BaseType_t xTmax = portMAX_DELAY;
 
+    // Higher priority task index.
+    UBaseType_t uxHigherPrioIndex = uxIndex - 1;
+
     // TCB of the higher priority task.
-    HstTCB_t * pxHigherPrioTask = ( HstTCB_t * ) listGET_LIST_ITEM_OWNER( pxHigherPrioTaskListItem );
+    HstTCB_t * pxHigherPrioTask = xHstTaskSet.pxTask[ uxHigherPrioIndex ];
     TaskSs_t* pxHigherPrioTaskSlack = ( TaskSs_t* ) pxHigherPrioTask->vExt;
 
-    // Corollary 2 (follows theorem 5)
-    if ( ( pxHigherPrioTaskSlack->xDi + pxHigherPrioTask->xWcet >= xDi ) && ( xDi >= pxHigherPrioTaskSlack->xTtma ) )
-    {
-        pxTaskSlack->xSlack = pxHigherPrioTaskSlack->xSlack - pxTask->xWcet;
-        pxTaskSlack->xTtma = pxHigherPrioTaskSlack->xTtma;
-        return;
-    }
-
     // Theorem 3
     TickType_t xIntervalo = xXi + pxTask->xDeadline - pxTask->xWcrt + pxTask->xWcet;
 
-    // Corollary 1 (follows theorem 4)
-    if ( ( pxHigherPrioTaskSlack->xDi + pxHigherPrioTask->xWcet >= xIntervalo ) && ( pxHigherPrioTaskSlack->xDi + pxHigherPrioTask->xWcet <= xDi ) )
+    // The corollaries reuse the slack of the higher priority task, only once
+    // its own computation is complete
+    if( pxHigherPrioTaskSlack->xPending == pdFALSE )
     {
-    	xIntervalo = pxHigherPrioTaskSlack->xDi + pxHigherPrioTask->xWcet;
-    	xKmax = pxHigherPrioTaskSlack->xSlack - pxTask->xWcet;
-    	xTmax = pxHigherPrioTaskSlack->xTtma;
+        // The slack of each task excludes its blocking term (resource.h), add
+        // it back when reusing the slack of the higher priority task.
+        const BaseType_t xHigherPrioSlack = pxSlack[ uxHigherPrioIndex ] + ( BaseType_t ) pxBlocking[ uxHigherPrioIndex ];
+
+        // Corollary 2 (follows theorem 5)
+        if ( ( pxHigherPrioTaskSlack->xDi + pxHigherPrioTask->xWcet >= xDi ) && ( xDi >= pxHigherPrioTaskSlack->xTtma ) )
+        {
+            pxSlack[ uxIndex ] = xHigherPrioSlack - pxTask->xWcet - pxBlocking[ uxIndex ];
+            pxTaskSlack->xTtma = pxHigherPrioTaskSlack->xTtma;
+            return;
+        }
+
+        // Corollary 1 (follows theorem 4)
+        if ( ( pxHigherPrioTaskSlack->xDi + pxHigherPrioTask->xWcet >= xIntervalo ) && ( pxHigherPrioTaskSlack->xDi + pxHigherPrioTask->xWcet <= xDi ) )
+        {
+        	xIntervalo = pxHigherPrioTaskSlack->xDi + pxHigherPrioTask->xWcet;
+        	xKmax = xHigherPrioSlack - pxTask->xWcet;
+        	xTmax = pxHigherPrioTaskSlack->xTtma;
+        }
     }
 
-    TickType_t xWc = xSlackGetWorkLoad( pxTask, xTc );
+    uint32_t ulReleased;
+    TickType_t xWc = xSlackGetWorkLoad( uxIndex, xTc, &ulReleased );
 
     // Calculate slack at xTask deadline (xDi)
-    BaseType_t xK2 = prvSlackCalcSlack( pxTask, xTc, xDi, xWc );
+    BaseType_t xK2 = prvSlackCalcSlack( uxIndex, xTc, xDi, xWc, ulReleased );
 
     if ( xK2 >= xKmax )
     {
@@ -83,127 +234,672 @@ void vSlackCalculateSlack_fixed1( HstTCB_t * pxTask, const TickType_t xTc )
         xKmax = xK2;
     }
 
-    TickType_t xii;
+    // The slack in [intervalo, xDi), for each higher priority task, is found
+    // by prvSlackStep(); until then the slack found so far is a lower bound
+    pxTaskSlack->xTc = xTc;
+    pxTaskSlack->xWc = xWc;
+    pxTaskSlack->ulReleased = ulReleased;
+    pxTaskSlack->xIntervalo = xIntervalo;
+    pxTaskSlack->uxHigher = uxHigherPrioIndex;
+    pxTaskSlack->xNext = prvSlackFirstRelease( uxHigherPrioIndex, xIntervalo );
+    pxTaskSlack->xKmax = xKmax;
+    pxTaskSlack->xTmax = xTmax;
+    pxTaskSlack->xCharged = 0;
+
+    pxSlack[ uxIndex ] = xKmax - ( BaseType_t ) pxBlocking[ uxIndex ];
+    pxTaskSlack->xTtma = xTmax;
+    prvSlackSetPending( pxTaskSlack, pdTRUE );
+}
 
-    // Find the slack in [intervalo, xDi)
-    do
-    {
-    	pxHigherPrioTask = ( HstTCB_t * ) listGET_LIST_ITEM_OWNER( pxHigherPrioTaskListItem );
+void vSlackCalculateSlack_fixed1( HstTCB_t * pxTask, const TickType_t xTc )
+{
+	const TaskSs_t * const pxTaskSlack = ( TaskSs_t * ) pxTask->vExt;
+
+	vSlackStartSlack( pxTask, xTc );
+
+	while( pxTaskSlack->xPending != pdFALSE )
+	{
+		prvSlackStep( pxTask->uxIndex );
+	}
+}
+
+/**
+ * Davis' approximate dynamic slack: the slack of the task at its deadline,
+ * without the release points before it.
+ */
+static void prvSlackApproxSlack( HstTCB_t * pxTask, const TickType_t xTc )
+{
+	const UBaseType_t uxIndex = pxTask->uxIndex;
+	TaskSs_t * const pxTaskSlack = ( TaskSs_t * ) pxTask->vExt;
+	const TickType_t xDi = pxTask->xRelease + pxTask->xDeadline;
+
+	if( uxIndex == 0U )
+	{
+		/* Exact, and O(1). */
+		vSlackStartSlack( pxTask, xTc );
+		return;
+	}
+
+	uint32_t ulReleased;
+	const TickType_t xWc = xSlackGetWorkLoad( uxIndex, xTc, &ulReleased );
+	BaseType_t xK = prvSlackCalcSlack( uxIndex, xTc, xDi, xWc, ulReleased );
+
+	if( xK < 0 )
+	{
+		xK = 0;
+	}
+
+	prvSlackSetPending( pxTaskSlack, pdFALSE );
+	pxTaskSlack->xDi = xDi;
+	pxTaskSlack->xTtma = xDi;
+	xHstTaskSet.pxSlack[ uxIndex ] = xK - ( BaseType_t ) xHstTaskSet.pxBlocking[ uxIndex ];
+}
+
+/**
+ * The release point search, stopped after SLACK_BOUNDED_POINTS steps with the
+ * slack found so far.
+ */
+static void prvSlackBoundedSlack( HstTCB_t * pxTask, const TickType_t xTc )
+{
+	TaskSs_t * const pxTaskSlack = ( TaskSs_t * ) pxTask->vExt;
+	UBaseType_t uxI;
+
+	vSlackStartSlack( pxTask, xTc );
+
+	for( uxI = 0; ( uxI < SLACK_BOUNDED_POINTS ) && ( pxTaskSlack->xPending != pdFALSE ); uxI++ )
+	{
+		prvSlackStep( pxTask->uxIndex );
+	}
+
+	if( pxTaskSlack->xPending != pdFALSE )
+	{
+		prvSlackRaise( pxTask->uxIndex );
+		pxTaskSlack->xTtma = pxTaskSlack->xTmax;
+		prvSlackSetPending( pxTaskSlack, pdFALSE );
+	}
+}
+
+void vSlackJobEnd( HstTCB_t * pxTask, const TickType_t xTc )
+{
+#if ( SLACK_METHOD == SLACK_APPROX )
+	prvSlackApproxSlack( pxTask, xTc );
+#elif ( SLACK_METHOD == SLACK_BOUNDED )
+	prvSlackBoundedSlack( pxTask, xTc );
+#elif ( SLACK_METHOD == SLACK_FIXED )
+	TaskSs_t * const pxTaskSlack = ( TaskSs_t * ) pxTask->vExt;
+
+	xHstTaskSet.pxSlack[ pxTask->uxIndex ] = pxTaskSlack->xK;
+#elif ( SLACK_METHOD == SLACK_TABLE )
+	vSlackTableSlack( pxTask, xTc );
+#else
+	/* Completed by xSlackResumeSlack(). */
+	vSlackStartSlack( pxTask, xTc );
+#endif
+}
+
+void vSlackRecalculate( const TickType_t xTc )
+{
+	const UBaseType_t uxCount = xHstTaskSet.uxCount;
+	BaseType_t xRemaining = 0;
+	UBaseType_t uxI;
+
+	/* The ticks counted so far are in xTc already. */
+	vSlackSync();
+
+	xSlackTableStale = pdFALSE;
+
+	for( uxI = 0; uxI < uxCount; uxI++ )
+	{
+		HstTCB_t * const pxTask = xHstTaskSet.pxTask[ uxI ];
+		const TickType_t xWcet = xHstTaskSet.pxWcet[ uxI ];
+
+		if( ( pxSlackTable != NULL ) && ( pxSlackTable[ uxI ].xWcet != xWcet ) )
+		{
+			xSlackTableStale = pdTRUE;
+		}
+
+		/* The workload counts the current jobs as completed, as at a job end:
+		 * the rest of the ones in progress is not. */
+		if( ( pxTask->xState != HST_FINISHED ) && ( xWcet > pxTask->xCur ) )
+		{
+			xRemaining = xRemaining + ( BaseType_t ) ( xWcet - pxTask->xCur );
+		}
+
+		vSlackCalculateSlack_fixed1( pxTask, xTc );
+		xHstTaskSet.pxSlack[ uxI ] = xHstTaskSet.pxSlack[ uxI ] - xRemaining;
+	}
+
+	xSlackRecalculated = pdTRUE;
+	vSlackUpdateAvailableSlack( &xAvailableSlack );
+}
+
+BaseType_t xSlackResumeSlack( UBaseType_t uxSteps )
+{
+	const UBaseType_t uxCount = xHstTaskSet.uxCount;
+	UBaseType_t uxI;
+
+	/* Highest priority first: the corollaries of the lower priority tasks
+	 * reuse its result. */
+	for( uxI = 0; ( uxI < uxCount ) && ( uxSlackPending > 0U ) && ( uxSteps > 0U ); uxI++ )
+	{
+		const TaskSs_t * const pxTaskSlack = ( TaskSs_t * ) xHstTaskSet.pxTask[ uxI ]->vExt;
+
+		while( ( pxTaskSlack->xPending != pdFALSE ) && ( uxSteps > 0U ) )
+		{
+			prvSlackStep( uxI );
+			uxSteps--;
+		}
+	}
+
+	return ( uxSlackPending > 0U ) ? pdTRUE : pdFALSE;
+}
+
+UBaseType_t uxSlackGetPending( void )
+{
+	return uxSlackPending;
+}
+
+static TickType_t prvSlackGcd( TickType_t xA, TickType_t xB )
+{
+	while( xB != 0U )
+	{
+		const TickType_t xR = xA % xB;
+
+		xA = xB;
+		xB = xR;
+	}
+
+	return xA;
+}
+
+/**
+ * Entry of the slack table of the task at uxIndex for the job released at
+ * xRelease: the largest slack at the release points checked by
+ * vSlackStartSlack(), as if the previous job ended at its own release, with
+ * no workload completed. The overheads are charged from that release, so the
+ * entry never exceeds the slack for a later job end.
+ */
+static BaseType_t prvSlackTableEntry( const UBaseType_t uxIndex, const TickType_t xRelease )
+{
+	const HstTCB_t * const pxTask = xHstTaskSet.pxTask[ uxIndex ];
+	const TickType_t xTc = xRelease - pxTask->xPeriod;
+	const TickType_t xDi = xRelease + pxTask->xDeadline;
+	const TickType_t xIntervalo = xRelease + pxTask->xDeadline - pxTask->xWcrt + pxTask->xWcet;
+	uint32_t ulReleased = 0U;
+	UBaseType_t uxI;
+
+	for( uxI = 0; uxI <= uxIndex; uxI++ )
+	{
+		if( xTc > xHstTaskSet.pxOffset[ uxI ] )
+		{
+			ulReleased = ulReleased + U_FLOOR_R( xTc - xHstTaskSet.pxOffset[ uxI ], xHstTaskSet.pxPeriod[ uxI ], xHstTaskSet.pulPeriodRecip[ uxI ] );
+		}
+	}
 
-    	xii = U_CEIL( xIntervalo, pxHigherPrioTask->xPeriod ) * pxHigherPrioTask->xPeriod;
+	BaseType_t xKmax = prvSlackCalcSlack( uxIndex, xTc, xDi, 0U, ulReleased );
 
-		while( xii < xDi )
+	for( uxI = 0; uxI < uxIndex; uxI++ )
+	{
+		TickType_t xii;
+
+		for( xii = prvSlackFirstRelease( uxI, xIntervalo ); xii < xDi; xii = xii + xHstTaskSet.pxPeriod[ uxI ] )
 		{
-			xK2 = prvSlackCalcSlack( pxTask, xTc, xii, xWc );
+			const BaseType_t xK2 = prvSlackCalcSlack( uxIndex, xTc, xii, 0U, ulReleased );
 
 			if( xK2 > xKmax )
 			{
 				xKmax = xK2;
-				xTmax = xii;
 			}
-			else if( ( xK2 == xKmax ) && ( xii < xTmax ) )
+		}
+	}
+
+	return xKmax;
+}
+
+BaseType_t xSlackBuildTable( void )
+{
+	const UBaseType_t uxCount = xHstTaskSet.uxCount;
+	TickType_t xHyperperiod = 1U;
+	TickType_t xStart = 0U;
+	size_t xDeltas = 0U;
+	UBaseType_t uxI, uxE;
+
+	if( pxSlackTable != NULL )
+	{
+		vPortFree( pxSlackTable );
+		pxSlackTable = NULL;
+		xSlackTableSize = 0U;
+	}
+
+	for( uxI = 0; uxI < uxCount; uxI++ )
+	{
+		const TickType_t xPeriod = xHstTaskSet.pxPeriod[ uxI ];
+
+		const TickType_t xFactor = xHyperperiod / prvSlackGcd( xHyperperiod, xPeriod );
+
+		if( xFactor > ( portMAX_DELAY / xPeriod ) )
+		{
+			/* The hyperperiod does not fit in a TickType_t. */
+			return pdFALSE;
+		}
+
+		xHyperperiod = xFactor * xPeriod;
+	}
+
+	/* First hyperperiod boundary after the offsets. */
+	for( uxI = 0; uxI < uxCount; uxI++ )
+	{
+		while( xStart < xHstTaskSet.pxOffset[ uxI ] )
+		{
+			if( xStart > ( portMAX_DELAY - ( 3U * xHyperperiod ) ) )
+			{
+				return pdFALSE;
+			}
+
+			xStart = xStart + xHyperperiod;
+		}
+	}
+
+	if( xStart > ( portMAX_DELAY - ( 3U * xHyperperiod ) ) )
+	{
+		return pdFALSE;
+	}
+
+	/* The highest priority task has no table, its slack takes O(1). */
+	for( uxI = 1; uxI < uxCount; uxI++ )
+	{
+		xDeltas = xDeltas + ( xHyperperiod / xHstTaskSet.pxPeriod[ uxI ] ) - 1U;
+	}
+
+	const size_t xSize = ( uxCount * sizeof( SlackTable_t ) ) + ( xDeltas * sizeof( int16_t ) );
+	SlackTable_t * const pxTable = ( SlackTable_t * ) pvPortMalloc( xSize );
+
+	if( pxTable == NULL )
+	{
+		return pdFALSE;
+	}
+
+	int16_t * const pxDeltas = ( int16_t * ) &( pxTable[ uxCount ] );
+	uint32_t ulDelta = 0U;
+	TickType_t xDemand = 0U;
+
+	for( uxI = 0; uxI < uxCount; uxI++ )
+	{
+		const TickType_t xPeriod = xHstTaskSet.pxPeriod[ uxI ];
+		SlackTable_t * const pxEntry = &( pxTable[ uxI ] );
+
+		xDemand = xDemand + ( ( xHyperperiod / xPeriod ) * xHstTaskSet.pxWcet[ uxI ] );
+
+		pxEntry->ulDelta = ulDelta;
+		pxEntry->xFirst = 0;
+		pxEntry->xDemand = xDemand;
+		pxEntry->xWcet = xHstTaskSet.pxWcet[ uxI ];
+		pxEntry->uxJobs = 0U;
+		pxEntry->ulJobsRecip = 0U;
+		pxEntry->ulFirstJob = 0U;
+		pxEntry->uxCursor = 0U;
+		pxEntry->xCursor = 0;
+
+		if( uxI == 0U )
+		{
+			continue;
+		}
+
+		pxEntry->uxJobs = xHyperperiod / xPeriod;
+		pxEntry->ulJobsRecip = ulUtilsReciprocal( pxEntry->uxJobs );
+		pxEntry->ulFirstJob = ( xStart / xPeriod ) + 1U;
+
+		/* The job of entry 0 is the one after the first job at or after
+		 * xStart + offset. */
+		BaseType_t xPrevious = prvSlackTableEntry( uxI, xHstTaskSet.pxOffset[ uxI ] + xStart + xPeriod );
+		pxEntry->xFirst = xPrevious;
+		pxEntry->xCursor = xPrevious;
+
+		for( uxE = 1; uxE < pxEntry->uxJobs; uxE++ )
+		{
+			const BaseType_t xNext = prvSlackTableEntry( uxI, xHstTaskSet.pxOffset[ uxI ] + xStart + ( ( uxE + 1U ) * xPeriod ) );
+			const BaseType_t xDiff = xNext - xPrevious;
+
+			if( ( xDiff > INT16_MAX ) || ( xDiff < INT16_MIN ) )
 			{
-				xTmax = xii;
+				vPortFree( pxTable );
+				return pdFALSE;
 			}
 
-			xii = xii + pxHigherPrioTask->xPeriod;
+			pxDeltas[ ulDelta ] = ( int16_t ) xDiff;
+			ulDelta++;
+			xPrevious = xNext;
 		}
+	}
 
-    	// Get the next higher priority task
-		pxHigherPrioTaskListItem = pxHigherPrioTaskListItem->pxPrevious;
-    }
-    while ( pxTaskListEndItem != pxHigherPrioTaskListItem );
+	pxSlackTable = pxTable;
+	pxSlackDeltas = pxDeltas;
+	xSlackTableSize = xSize;
+	xSlackTableStale = pdFALSE;
 
-    pxTaskSlack->xSlack = xKmax;
-    pxTaskSlack->xTtma = xTmax;
+	return pdTRUE;
+}
+
+size_t xSlackGetTableSize( void )
+{
+	return xSlackTableSize;
+}
+
+/**
+ * Entry uxEntry of the table, from the last one looked up: the jobs of a task
+ * end in order, so this takes O(1) but after a skipped job or a new
+ * hyperperiod.
+ */
+static BaseType_t prvSlackTableLookup( SlackTable_t * const pxTable, const UBaseType_t uxEntry )
+{
+	if( uxEntry < pxTable->uxCursor )
+	{
+		pxTable->uxCursor = 0U;
+		pxTable->xCursor = pxTable->xFirst;
+	}
+
+	while( pxTable->uxCursor < uxEntry )
+	{
+		pxTable->xCursor = pxTable->xCursor + pxSlackDeltas[ pxTable->ulDelta + pxTable->uxCursor ];
+		pxTable->uxCursor++;
+	}
+
+	return pxTable->xCursor;
+}
+
+void vSlackTableSlack( HstTCB_t * pxTask, const TickType_t xTc )
+{
+	const UBaseType_t uxIndex = pxTask->uxIndex;
+	TaskSs_t * const pxTaskSlack = ( TaskSs_t * ) pxTask->vExt;
+
+	if( ( pxSlackTable == NULL ) || ( xSlackTableStale != pdFALSE ) || ( uxIndex == 0U ) )
+	{
+		vSlackStartSlack( pxTask, xTc );
+		return;
+	}
+
+	SlackTable_t * const pxTable = &( pxSlackTable[ uxIndex ] );
+
+	/* The job that ended was released at xRelease - xPeriod. */
+	const TickType_t xRelease = pxTask->xRelease;
+	uint32_t ulJob = U_FLOOR_R( xRelease - pxTask->xOffset, pxTask->xPeriod, xHstTaskSet.pulPeriodRecip[ uxIndex ] );
+
+	if( ulJob < pxTable->ulFirstJob )
+	{
+		/* Before the hyperperiods in the table, while the offsets pass. */
+		vSlackStartSlack( pxTask, xTc );
+		return;
+	}
+
+	ulJob = ulJob - pxTable->ulFirstJob;
+
+	const uint32_t ulHyperperiods = U_FLOOR_R( ulJob, pxTable->uxJobs, pxTable->ulJobsRecip );
+	const BaseType_t xEntry = prvSlackTableLookup( pxTable, ulJob - ( ulHyperperiods * pxTable->uxJobs ) );
+
+	uint32_t ulReleased;
+	const TickType_t xWc = xSlackGetWorkLoad( uxIndex, xTc, &ulReleased );
+
+	/* The entry, moved on by the hyperperiods elapsed, less the time since the
+	 * release of the job, plus the workload completed. */
+	BaseType_t xK = xEntry - ( BaseType_t ) ( ulHyperperiods * pxTable->xDemand ) - ( BaseType_t ) ( xTc - ( xRelease - pxTask->xPeriod ) ) + ( BaseType_t ) xWc;
+
+	if( xK < 0 )
+	{
+		xK = 0;
+	}
+
+	prvSlackSetPending( pxTaskSlack, pdFALSE );
+	pxTaskSlack->xDi = xRelease + pxTask->xDeadline;
+	pxTaskSlack->xTtma = pxTaskSlack->xDi;
+	xHstTaskSet.pxSlack[ uxIndex ] = xK - ( BaseType_t ) xHstTaskSet.pxBlocking[ uxIndex ];
 }
 
 inline void vSlackUpdateAvailableSlack( BaseType_t * xAvailableSlack )
 {
-	const ListItem_t * pxAppTasksListEndMarker = listGET_END_MARKER( pxAllTasksList );
-	ListItem_t * pxAppTasksListItem = listGET_HEAD_ENTRY( pxAllTasksList );
+	const UBaseType_t uxCount = xHstTaskSet.uxCount;
+	const BaseType_t * const pxSlack = xHstTaskSet.pxSlack;
+
+	BaseType_t xMin = 0;
+	UBaseType_t uxI;
+
+	if( uxCount == 0 )
+	{
+		*xAvailableSlack = 0;
+		return;
+	}
 
-	*xAvailableSlack = ( ( TaskSs_t* ) ( ( HstTCB_t * ) listGET_LIST_ITEM_OWNER( pxAppTasksListItem ) )->vExt )->xSlack;
+	xMin = pxSlack[ 0 ];
 
-	while( pxAppTasksListEndMarker != pxAppTasksListItem )
+	for( uxI = 1; uxI < uxCount; uxI++ )
 	{
-		if( ( ( TaskSs_t* ) ( ( HstTCB_t * ) listGET_LIST_ITEM_OWNER( pxAppTasksListItem ) )->vExt )->xSlack < *xAvailableSlack )
+		if( pxSlack[ uxI ] < xMin )
 		{
-			*xAvailableSlack = ( ( TaskSs_t* ) ( ( HstTCB_t * ) listGET_LIST_ITEM_OWNER( pxAppTasksListItem ) )->vExt )->xSlack;
+			xMin = pxSlack[ uxI ];
 		}
+	}
+
+	*xAvailableSlack = xMin;
+}
+
+/**
+ * Slack left after xTicks ticks charged to a counter: each tick decrements
+ * the counter only while it is positive.
+ */
+static inline BaseType_t prvSlackCharge( const BaseType_t xSlack, const TickType_t xTicks )
+{
+	if( xSlack <= 0 )
+	{
+		return xSlack;
+	}
+
+	if( xSlack > ( BaseType_t ) xTicks )
+	{
+		return xSlack - ( BaseType_t ) xTicks;
+	}
+
+	return 0;
+}
+
+void vSlackTick( void )
+{
+	xSlackPendingLevel++;
 
-		pxAppTasksListItem = listGET_NEXT( pxAppTasksListItem );
+	if( uxSlackLevel > 0U )
+	{
+		xSlackMinAbove = prvSlackCharge( xSlackMinAbove, 1U );
 	}
+
+	xAvailableSlack = ( xSlackMinAbove < xSlackMinBelow ) ? xSlackMinAbove : xSlackMinBelow;
 }
 
-inline void vSlackDecrementAllTasksSlack( const TickType_t xTicks )
+void vSlackSync( void )
 {
-	const ListItem_t * pxAppTasksListEndMarker = listGET_END_MARKER( pxAllTasksList );
-	ListItem_t * pxAppTasksListItem = listGET_HEAD_ENTRY( pxAllTasksList );
+	const UBaseType_t uxCount = xHstTaskSet.uxCount;
+	BaseType_t * const pxSlack = xHstTaskSet.pxSlack;
+	TickType_t xAll, xLevel;
+	UBaseType_t uxLevel, uxI;
+
+	taskENTER_CRITICAL();
+	{
+		xAll = xSlackPendingAll;
+		xLevel = xSlackPendingLevel;
+		uxLevel = uxSlackLevel;
 
-	while( pxAppTasksListEndMarker != pxAppTasksListItem )
+		xSlackPendingAll = 0U;
+		xSlackPendingLevel = 0U;
+	}
+	taskEXIT_CRITICAL();
+
+	if( ( xAll == 0U ) && ( xLevel == 0U ) )
+	{
+		return;
+	}
+
+	for( uxI = 0; uxI < uxCount; uxI++ )
 	{
-		TaskSs_t* tmpTask = ( TaskSs_t* ) ( ( HstTCB_t * ) listGET_LIST_ITEM_OWNER( pxAppTasksListItem ) )->vExt;
+		const TickType_t xTicks = ( uxI < uxLevel ) ? xAll + xLevel : xAll;
 
-		if( tmpTask->xSlack > 0 )
+		pxSlack[ uxI ] = prvSlackCharge( pxSlack[ uxI ], xTicks );
+
+		if( uxSlackPending > 0U )
 		{
-			tmpTask->xSlack = tmpTask->xSlack - ( BaseType_t ) xTicks;
-		}
+			TaskSs_t * const pxTaskSlack = ( TaskSs_t * ) xHstTaskSet.pxTask[ uxI ]->vExt;
 
-		pxAppTasksListItem = listGET_NEXT( pxAppTasksListItem );
+			if( pxTaskSlack->xPending != pdFALSE )
+			{
+				pxTaskSlack->xCharged += ( BaseType_t ) xTicks;
+			}
+		}
 	}
 }
 
-inline void vSlackDecrementTasksSlack( const HstTCB_t * pxTask, const TickType_t xTicks )
+void vSlackSetLevel( const UBaseType_t uxLevel )
 {
-	const ListItem_t * pxAppTasksListEndMarker = &( pxTask->xGenericListItem );
-	ListItem_t * pxAppTasksListItem = listGET_HEAD_ENTRY( pxAllTasksList );
+	const UBaseType_t uxCount = xHstTaskSet.uxCount;
+	const BaseType_t * const pxSlack = xHstTaskSet.pxSlack;
+	BaseType_t xAbove = slackNO_TASKS;
+	BaseType_t xBelow = slackNO_TASKS;
+	UBaseType_t uxI;
+
+	for( uxI = 0; uxI < uxCount; uxI++ )
+	{
+		if( uxI < uxLevel )
+		{
+			xAbove = ( pxSlack[ uxI ] < xAbove ) ? pxSlack[ uxI ] : xAbove;
+		}
+		else
+		{
+			xBelow = ( pxSlack[ uxI ] < xBelow ) ? pxSlack[ uxI ] : xBelow;
+		}
+	}
+
+	if( uxCount == 0U )
+	{
+		/* No slack to steal. */
+		xAbove = 0;
+		xBelow = 0;
+	}
+
+	xSlackRecalculated = pdFALSE;
 
-	while( pxAppTasksListEndMarker != pxAppTasksListItem )
+	taskENTER_CRITICAL();
 	{
-		TaskSs_t* tmpTask = ( TaskSs_t* ) ( ( HstTCB_t * ) listGET_LIST_ITEM_OWNER( pxAppTasksListItem ) )->vExt;
+		/* The ticks counted since vSlackSync() were charged to the previous
+		 * level: charge them to every task, which never overestimates the
+		 * slack of any of them. */
+		xSlackPendingAll = xSlackPendingAll + xSlackPendingLevel;
+		xSlackPendingLevel = 0U;
+		uxSlackLevel = uxLevel;
+
+		if( xAbove != slackNO_TASKS )
+		{
+			xAbove = prvSlackCharge( xAbove, xSlackPendingAll );
+		}
 
-		if( tmpTask->xSlack > 0 )
+		if( xBelow != slackNO_TASKS )
 		{
-			tmpTask->xSlack = tmpTask->xSlack - ( BaseType_t ) xTicks;
+			xBelow = prvSlackCharge( xBelow, xSlackPendingAll );
 		}
 
-		pxAppTasksListItem = listGET_NEXT( pxAppTasksListItem );
+		xSlackMinAbove = xAbove;
+		xSlackMinBelow = xBelow;
+		xAvailableSlack = ( xAbove < xBelow ) ? xAbove : xBelow;
+	}
+	taskEXIT_CRITICAL();
+}
+
+BaseType_t xSlackGetSlack( const UBaseType_t uxIndex )
+{
+	BaseType_t xSlack;
+
+	taskENTER_CRITICAL();
+	{
+		const TickType_t xTicks = ( uxIndex < uxSlackLevel ) ? xSlackPendingAll + xSlackPendingLevel : xSlackPendingAll;
+
+		xSlack = prvSlackCharge( xHstTaskSet.pxSlack[ uxIndex ], xTicks );
+	}
+	taskEXIT_CRITICAL();
+
+	return xSlack;
+}
+
+BaseType_t xSlackGetSlackUntil( const TickType_t xTc, const TickType_t xD )
+{
+	if( xD <= xTc )
+	{
+		return 0;
 	}
+
+	const TickType_t xLength = xD - xTc;
+
+	/* The available slack, used at once by the aperiodic jobs: ss serves
+	 * them only on the slack, never in the background. */
+	const BaseType_t xSlack = ( xAvailableSlack < ( BaseType_t ) xLength ) ? xAvailableSlack : ( BaseType_t ) xLength;
+
+	return ( xSlack > 0 ) ? xSlack : 0;
 }
 
 inline void vSlackGainSlack( const HstTCB_t * pxTask, const TickType_t xTicks )
 {
-	const ListItem_t * pxAppTasksListEndMarker = listGET_END_MARKER( pxAllTasksList );
-	ListItem_t * pxAppTasksListItem = listGET_NEXT( &( pxTask->xGenericListItem ) );
+	const UBaseType_t uxCount = xHstTaskSet.uxCount;
+	BaseType_t * const pxSlack = xHstTaskSet.pxSlack;
+	UBaseType_t uxI;
 
-	while( pxAppTasksListItem != pxAppTasksListEndMarker )
+	if( xSlackRecalculated != pdFALSE )
 	{
-		( ( TaskSs_t* ) ( ( HstTCB_t * ) listGET_LIST_ITEM_OWNER( pxAppTasksListItem ) )->vExt )->xSlack += ( BaseType_t ) xTicks;
-		pxAppTasksListItem = listGET_NEXT( pxAppTasksListItem );
+		return;
+	}
+
+	/* Only the lower priority tasks, ( uxIndex, uxCount ). */
+	for( uxI = pxTask->uxIndex + 1; uxI < uxCount; uxI++ )
+	{
+		pxSlack[ uxI ] += ( BaseType_t ) xTicks;
+
+		if( uxSlackPending > 0U )
+		{
+			TaskSs_t * const pxTaskSlack = ( TaskSs_t * ) xHstTaskSet.pxTask[ uxI ]->vExt;
+
+			if( pxTaskSlack->xPending != pdFALSE )
+			{
+				pxTaskSlack->xCharged -= ( BaseType_t ) xTicks;
+			}
+		}
 	}
 }
 
-static inline TickType_t xSlackGetWorkLoad( HstTCB_t * pxTask, const TickType_t xTc )
+/**
+ * Workload of the tasks [0, uxIndex] completed before xTc. Jobs are released
+ * at the task offset plus a multiple of its period.
+ *
+ * @param pulReleased number of jobs released up to xTc, for the overheads.
+ */
+static inline TickType_t xSlackGetWorkLoad( const UBaseType_t uxIndex, const TickType_t xTc, uint32_t * const pulReleased )
 {
     TickType_t xW = ( TickType_t ) 0U;	// Workload
 	TickType_t xA = ( TickType_t ) 0U;
 	TickType_t xC = ( TickType_t ) 0U;
 
-	const ListItem_t * pxAppTasksListEndMarker = listGET_END_MARKER( pxAllTasksList );
-	ListItem_t * pxAppTasksListItem = &( pxTask->xGenericListItem );
+	UBaseType_t uxI;
 
-	// Until we process all the maximum priority tasks (including pxTask)
-	while( pxAppTasksListEndMarker != pxAppTasksListItem )
+	*pulReleased = 0U;
+
+	// Process all the higher priority tasks (including the task at uxIndex)
+	for( uxI = 0; uxI <= uxIndex; uxI++ )
 	{
-		HstTCB_t * pxHighPrioTask = listGET_LIST_ITEM_OWNER( pxAppTasksListItem );
+		const TickType_t xWcet = xHstTaskSet.pxWcet[ uxI ];
+		const TickType_t xOffset = xHstTaskSet.pxOffset[ uxI ];
 
-		// The number of instances of pxHigherPrioTask in [0, xT)
-		xA = U_FLOOR( xTc, pxHighPrioTask->xPeriod );
+		// The number of instances of the higher priority task in [0, xT)
+		xA = ( TickType_t ) 0U;
+		xC = ( TickType_t ) 0U;
 
-		if( xTc > ( TickType_t ) 0U )
+		if( xTc > xOffset )
 		{
-			if( pxHighPrioTask->xWcet == pxHighPrioTask->xCur )
+			const HstTCB_t * pxHighPrioTask = xHstTaskSet.pxTask[ uxI ];
+
+			xA = U_FLOOR_R( xTc - xOffset, xHstTaskSet.pxPeriod[ uxI ], xHstTaskSet.pulPeriodRecip[ uxI ] );
+
+			if( xWcet == pxHighPrioTask->xCur )
 			{
 				if( xA >= pxHighPrioTask->uxReleaseCount )
 				{
@@ -211,39 +907,54 @@ static inline TickType_t xSlackGetWorkLoad( HstTCB_t * pxTask, const TickType_t
 				}
 				else
 				{
-					xC = pxHighPrioTask->xWcet;
+					xC = xWcet;
 				}
 			}
 			else
 			{
-				xC = pxHighPrioTask->xWcet;
+				xC = xWcet;
 			}
 		}
 
 		// Accumulated workload
-		xW = xW + ( xA * pxHighPrioTask->xWcet ) + xC;
-
-		pxAppTasksListItem = pxAppTasksListItem->pxPrevious;
+		xW = xW + ( xA * xWcet ) + xC;
+		*pulReleased = *pulReleased + xA;
 	}
 
     return xW;
 }
 
-static inline BaseType_t prvSlackCalcSlack( HstTCB_t * pxTask, const TickType_t xTc, const TickType_t xT, const TickType_t xWc )
+/**
+ * Slack of the task at uxIndex in [xTc, xT). The overheads of the jobs still
+ * to be dispatched in the interval (the pending ones, and the ones released
+ * after xTc) are charged as if each one preempted the task.
+ */
+static inline BaseType_t prvSlackCalcSlack( const UBaseType_t uxIndex, const TickType_t xTc, const TickType_t xT, const TickType_t xWc, const uint32_t ulReleased )
 {
-    const ListItem_t * pxAppTasksListEndMarker = listGET_END_MARKER( pxAllTasksList );
-    ListItem_t * pxAppTasksListItem = &( pxTask->xGenericListItem );
+	const TickType_t * const pxPeriod = xHstTaskSet.pxPeriod;
+	const uint32_t * const pulPeriodRecip = xHstTaskSet.pulPeriodRecip;
+	const TickType_t * const pxWcet = xHstTaskSet.pxWcet;
+	const TickType_t * const pxOffset = xHstTaskSet.pxOffset;
 
     TickType_t xW = 0;
+    uint32_t ulJobs = 0U;
+    UBaseType_t uxI;
 
-    while( pxAppTasksListEndMarker != pxAppTasksListItem )
+	/* Accumulated workload of higher priority tasks in [0, xT) */
+    for( uxI = 0; uxI <= uxIndex; uxI++ )
     {
-    	HstTCB_t * pxHighPrioTask = listGET_LIST_ITEM_OWNER( pxAppTasksListItem );
+    	if( xT > pxOffset[ uxI ] )
+    	{
+    		const TickType_t xJobs = U_CEIL_R( xT - pxOffset[ uxI ], pxPeriod[ uxI ], pulPeriodRecip[ uxI ] );
 
-    	/* Accumulated workload of higher priority tasks in [0, xT) */
-    	xW = xW + ( U_CEIL( xT, pxHighPrioTask->xPeriod ) * pxHighPrioTask->xWcet );
+    		xW = xW + ( xJobs * pxWcet[ uxI ] );
+    		ulJobs = ulJobs + xJobs;
+    	}
+    }
 
-    	pxAppTasksListItem = pxAppTasksListItem->pxPrevious;
+    if( ( xT > xTc ) && ( ulJobs > ulReleased ) )
+    {
+    	xW = xW + xWcrtGetOverhead( xT - xTc, ulJobs - ulReleased, ulJobs - ulReleased );
     }
 
     return ( BaseType_t ) xT - ( BaseType_t ) xTc - ( BaseType_t ) xW + ( BaseType_t ) xWc;
@@ -5,20 +5,67 @@ extern "C" {
 #endif
 
 #define USE_SLACK 	1
-#define USE_SLACK_K 0
+
+/* Slack computation at each job end (vSlackJobEnd()):
+ * - SLACK_EXACT: the largest slack at the release points of the higher
+ *   priority tasks up to the deadline, resumed over the HST activations.
+ * - SLACK_APPROX: Davis' approximate dynamic slack, the slack at the deadline
+ *   only, O(n).
+ * - SLACK_BOUNDED: the SLACK_EXACT search, stopped after SLACK_BOUNDED_POINTS
+ *   release points.
+ * - SLACK_FIXED: the slack at the critical instant, reloaded.
+ * - SLACK_TABLE: a table over the hyperperiod (xSlackBuildTable()).
+ * The approximations are lower bounds of the release point search. */
+#define SLACK_EXACT		0
+#define SLACK_APPROX	1
+#define SLACK_BOUNDED	2
+#define SLACK_FIXED		3
+#define SLACK_TABLE		4
+
+#ifndef SLACK_METHOD
+	#define SLACK_METHOD SLACK_EXACT
+#endif
+
+/* Release points checked by each HST activation for the slack computations
+ * in progress (xSlackResumeSlack()). */
+#define SLACK_STEPS 4
+
+/* Release points checked at a job end by SLACK_BOUNDED. */
+#define SLACK_BOUNDED_POINTS 8
 
 extern BaseType_t xAvailableSlack;
 
+/* The slack counters are stored in xHstTaskSet.pxSlack (taskset.h). */
 struct TaskInfo_Slack {
 	TickType_t xDi;
-	BaseType_t xSlack;
 	TickType_t xTtma;
 	TickType_t xK;
+
+	/* Slack computation in progress, see vSlackStartSlack(). */
+	BaseType_t xPending;
+	TickType_t xTc;
+	TickType_t xWc;
+	uint32_t ulReleased;
+	TickType_t xIntervalo;
+	UBaseType_t uxHigher;		/* Higher priority task, and */
+	TickType_t xNext;			/* its next release point to check. */
+	BaseType_t xKmax;
+	TickType_t xTmax;
+	BaseType_t xCharged;		/* Ticks charged less slack gained since xTc. */
 };
 
 typedef struct TaskInfo_Slack TaskSs_t;
 
 /**
+ * Slack of the task at xTc, its job end, by SLACK_METHOD.
+ *
+ * @param pxTask
+ * @param xTc
+ */
+void vSlackJobEnd( HstTCB_t * pxTask, const TickType_t xTc );
+
+/**
+ * Slack of the task at xTc, its job end, computed at once.
  *
  * @param pxTask
  * @param xTc
@@ -26,31 +73,126 @@ typedef struct TaskInfo_Slack TaskSs_t;
 void vSlackCalculateSlack_fixed1( HstTCB_t * pxTask, const TickType_t xTc );
 
 /**
+ * Starts the computation of the slack of the task at xTc, in O(n). The slack
+ * counter holds a lower bound of the result until xSlackResumeSlack() has
+ * checked the release points of the higher priority tasks, one per step.
  *
  * @param pxTask
- * @param xTicks
+ * @param xTc
  */
-void vSlackGainSlack( const HstTCB_t * pxTask, const TickType_t xTicks ); //  __attribute__((always_inline));
+void vSlackStartSlack( HstTCB_t * pxTask, const TickType_t xTc );
+
+/**
+ * Goes on with the slack computations in progress, highest priority first,
+ * for at most uxSteps steps of O(n) each.
+ *
+ * @param uxSteps
+ * @return pdTRUE if some computation is still in progress.
+ */
+BaseType_t xSlackResumeSlack( UBaseType_t uxSteps );
+
+/**
+ *
+ * @return the number of slack computations in progress.
+ */
+UBaseType_t uxSlackGetPending( void );
+
+/**
+ * Slack of every task at xTc, after the wcets changed (adaptive.h): the jobs
+ * in progress still need the rest of their wcet. The counters then already
+ * count the jobs finished by xTc, so vSlackGainSlack() gives nothing until
+ * the next vSlackSetLevel(). The slack table is not used while the wcets
+ * differ from the ones it was built with. One vSlackCalculateSlack_fixed1()
+ * per task, from the HST only.
+ *
+ * @param xTc
+ */
+void vSlackRecalculate( const TickType_t xTc );
+
+/**
+ * Builds the slack table of each task over the hyperperiod, for
+ * vSlackTableSlack(): one entry per job, stored as 16 bit differences. Also
+ * run by tools/hstc to report its size.
+ *
+ * @return pdFALSE if the hyperperiod does not fit in a TickType_t, a
+ * difference does not fit in 16 bits, or there is not enough memory. The
+ * slack is then computed by vSlackStartSlack().
+ */
+BaseType_t xSlackBuildTable( void );
+
+/**
+ *
+ * @return the memory taken by the slack table, in bytes, 0 without a table.
+ */
+size_t xSlackGetTableSize( void );
 
 /**
+ * Slack of the task at xTc, its job end, from the slack table in O(n): the
+ * entry of the job, adjusted by the workload completed by xTc. Without a table,
+ * or while the wcets differ from its own, it calls vSlackStartSlack().
  *
  * @param pxTask
- * @param xTicks
+ * @param xTc
  */
-void vSlackDecrementTasksSlack( const HstTCB_t * pxTask, const TickType_t xTicks );
+void vSlackTableSlack( HstTCB_t * pxTask, const TickType_t xTc );
 
 /**
  *
+ * @param pxTask
  * @param xTicks
  */
-void vSlackDecrementAllTasksSlack( const TickType_t xTicks );
+void vSlackGainSlack( const HstTCB_t * pxTask, const TickType_t xTicks ); //  __attribute__((always_inline));
 
 /**
+ * Minimum of the slack counters, brought up to date by vSlackSync(). O(n),
+ * from the HST only.
  *
  * @param xAvailableSlack
  */
 void vSlackUpdateAvailableSlack( BaseType_t * xAvailableSlack );
 
+/**
+ * Charges one tick to the tasks selected by vSlackSetLevel(), and updates
+ * xAvailableSlack. Only counts the tick, so it takes constant time: called
+ * from the tick hook.
+ */
+void vSlackTick( void );
+
+/**
+ * Charges to the slack counters in xHstTaskSet.pxSlack the ticks counted by
+ * vSlackTick(). The HST calls it before reading or writing the counters.
+ */
+void vSlackSync( void );
+
+/**
+ * Selects the tasks the next ticks are charged to, [0, uxLevel): the higher
+ * priority tasks of the running periodic task, or every task (uxCount) while
+ * an aperiodic task or the idle task runs. Updates the minima kept for
+ * vSlackTick(), so it follows any change to the counters.
+ *
+ * @param uxLevel
+ */
+void vSlackSetLevel( const UBaseType_t uxLevel );
+
+/**
+ * Slack of the task at uxIndex, with the ticks not yet charged by vSlackSync().
+ *
+ * @param uxIndex
+ * @return
+ */
+BaseType_t xSlackGetSlack( const UBaseType_t uxIndex );
+
+/**
+ * Lower bound of the slack the aperiodic jobs ready at xTc obtain in
+ * [xTc, xD): the available slack, used at once, up to xD - xTc. Constant
+ * time.
+ *
+ * @param xTc current time.
+ * @param xD
+ * @return
+ */
+BaseType_t xSlackGetSlackUntil( const TickType_t xTc, const TickType_t xD );
+
 /**
  *
  * @return
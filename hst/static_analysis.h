@@ -0,0 +1,445 @@
+#if !defined( __cplusplus ) || ( __cplusplus < 201402L )
+	#error "static_analysis.h is a C++14 header (-std=gnu++14)."
+#endif
+
+/* Include after scheduler.h and scheduler_logic.h (USE_QPA). */
+#include "FreeRTOS.h"
+
+/**
+ * Compile-time analysis of a static task set. The task set is a constexpr
+ * array of HstStaticTask_t, in priority order, and the analyses are constexpr
+ * functions, so an unschedulable task set fails the build:
+ *
+ *     static constexpr HstStaticTask_t xTasks[] =
+ *     {
+ *         { "T01", 3000, 3000, 1000, 0, 0 },
+ *         { "T02", 4000, 4000, 1000, 0, 0 },
+ *     };
+ *
+ *     static_assert( xHstStaticSchedulable( xTasks ), "Unschedulable task set." );
+ *
+ *     static constexpr HstStaticTables_t< 2 > xTables = xHstStaticTables( xTasks );
+ *
+ * The tables are constant data, in flash. Create the tasks with
+ * xHstStaticTaskSetCreate() and pass the tables with vHstStaticSetTables()
+ * before vSchedulerInit(), which then takes the response times from them
+ * instead of analysing the task set at boot.
+ *
+ * The tests are those of the policy (USE_QPA): the exact response time
+ * analysis with arbitrary deadlines under fixed priorities, QPA under EDF.
+ * They are computed with exact divisions, and ignore the release offsets and
+ * the overheads. The synchronous release is the worst case, so a task set with
+ * offsets the offset analysis of wcrt.c accepts may be rejected here. With
+ * overheads (configHST_TICK_OVERHEAD_CYCLES and the others, or
+ * vWcrtSetOverheads()), vSchedulerInit() ignores the tables and analyses the
+ * task set at boot, as for any table computed with other overheads. Under slack stealing the initial slacks are still
+ * computed at boot.
+ */
+
+/**
+ * Periodic task of a static task set. xBlocking is the blocking term its
+ * resources give it (resource.h), checked at boot with the other parameters.
+ */
+typedef struct
+{
+	const char *pcName;
+	TickType_t xPeriod;
+	TickType_t xDeadline;
+	TickType_t xWcet;
+	TickType_t xOffset;
+	TickType_t xBlocking;
+} HstStaticTask_t;
+
+/**
+ * Analysis tables of a static task set, in task set order (taskset.h).
+ */
+template< UBaseType_t N >
+struct HstStaticTables_t
+{
+	HstTableEntry_t xEntries[ N ];
+};
+
+/**
+ * Worst case response time of task uxIndex, below the tasks [0, uxIndex). As
+ * prvWcrtExact() in wcrt.c, every job of the level-i busy period is analysed
+ * when D > T.
+ *
+ * @return the worst case response time, or a value above the deadline.
+ */
+template< UBaseType_t N >
+constexpr TickType_t xHstStaticWcrt( const HstStaticTask_t ( &xTasks )[ N ], UBaseType_t uxIndex )
+{
+	const HstStaticTask_t & xTask = xTasks[ uxIndex ];
+	uint64_t ullRelease = 0U;                                       // Release of job q, q * T.
+	uint64_t ullWork = ( uint64_t ) xTask.xWcet + xTask.xBlocking;  // Own workload, B + ( q + 1 ) * C.
+	uint64_t ullT = ullWork;
+	uint64_t ullWcrt = 0U;
+
+	for( ;; )
+	{
+		const uint64_t ullLimit = ullRelease + xTask.xDeadline;
+		uint64_t ullW = ullT;
+
+		if( ullLimit > portMAX_DELAY )
+		{
+			/* The busy period does not fit in a TickType_t. */
+			return portMAX_DELAY;
+		}
+
+		while( ullT <= ullLimit )
+		{
+			ullW = ullWork;
+
+			for( UBaseType_t uxJ = 0; uxJ < uxIndex; uxJ++ )
+			{
+				ullW = ullW + ( ( ( ullT + xTasks[ uxJ ].xPeriod - 1U ) / xTasks[ uxJ ].xPeriod ) * xTasks[ uxJ ].xWcet );
+			}
+
+			if( ullW == ullT )
+			{
+				break;
+			}
+
+			ullT = ullW;
+		}
+
+		if( ullT > ullLimit )
+		{
+			/* Job q misses its deadline. */
+			return ( ( ullT - ullRelease ) < portMAX_DELAY ) ? ( TickType_t ) ( ullT - ullRelease ) : portMAX_DELAY;
+		}
+
+		if( ( ullT - ullRelease ) > ullWcrt )
+		{
+			ullWcrt = ullT - ullRelease;
+		}
+
+		/* The busy period ends before the next release. */
+		if( ( ullT - ullRelease ) <= xTask.xPeriod )
+		{
+			return ( TickType_t ) ullWcrt;
+		}
+
+		/* Job q + 1 completes at least C after job q. */
+		ullRelease = ullRelease + xTask.xPeriod;
+		ullWork = ullWork + xTask.xWcet;
+		ullT = ullT + xTask.xWcet;
+	}
+}
+
+/**
+ * Processor demand of the jobs with an absolute deadline at or before xT,
+ * plus the longest blocking term of their tasks (qpa.c).
+ */
+template< UBaseType_t N >
+constexpr uint64_t prvHstStaticDemand( const HstStaticTask_t ( &xTasks )[ N ], uint64_t ullT )
+{
+	uint64_t ullDemand = 0U;
+	TickType_t xBlocking = 0U;
+
+	for( UBaseType_t uxI = 0; uxI < N; uxI++ )
+	{
+		if( xTasks[ uxI ].xDeadline <= ullT )
+		{
+			ullDemand = ullDemand + ( ( ( ( ullT - xTasks[ uxI ].xDeadline ) / xTasks[ uxI ].xPeriod ) + 1U ) * xTasks[ uxI ].xWcet );
+
+			if( xTasks[ uxI ].xBlocking > xBlocking )
+			{
+				xBlocking = xTasks[ uxI ].xBlocking;
+			}
+		}
+	}
+
+	return ullDemand + xBlocking;
+}
+
+/**
+ * Latest absolute deadline before xT, or 0 if there is none.
+ */
+template< UBaseType_t N >
+constexpr uint64_t prvHstStaticPreviousDeadline( const HstStaticTask_t ( &xTasks )[ N ], uint64_t ullT )
+{
+	uint64_t ullLatest = 0U;
+
+	for( UBaseType_t uxI = 0; uxI < N; uxI++ )
+	{
+		if( xTasks[ uxI ].xDeadline < ullT )
+		{
+			const uint64_t ullD = xTasks[ uxI ].xDeadline + ( ( ( ullT - 1U - xTasks[ uxI ].xDeadline ) / xTasks[ uxI ].xPeriod ) * xTasks[ uxI ].xPeriod );
+
+			if( ullD > ullLatest )
+			{
+				ullLatest = ullD;
+			}
+		}
+	}
+
+	return ullLatest;
+}
+
+/**
+ * One past the last deadline that can fail, as prvQpaBound() in qpa.c.
+ *
+ * @return the bound, or 0 if the utilization exceeds 1.
+ */
+template< UBaseType_t N >
+constexpr uint64_t prvHstStaticDemandBound( const HstStaticTask_t ( &xTasks )[ N ] )
+{
+	const uint64_t ullOne = 0x10000U;
+	uint64_t ullUtilizationLo = 0U;
+	uint64_t ullUtilizationHi = 0U;
+	uint64_t ullLaxity = 0U;
+	uint64_t ullBound = portMAX_DELAY;
+	uint64_t ullMaxDeadline = 0U;
+	uint64_t ullMaxBlocking = 0U;
+	uint64_t ullW = 0U;
+	uint64_t ullPrevious = 0U;
+
+	for( UBaseType_t uxI = 0; uxI < N; uxI++ )
+	{
+		const uint64_t ullLo = ( ( uint64_t ) xTasks[ uxI ].xWcet << 16 ) / xTasks[ uxI ].xPeriod;
+
+		ullUtilizationLo = ullUtilizationLo + ullLo;
+		ullUtilizationHi = ullUtilizationHi + ullLo + 1U;
+
+		if( xTasks[ uxI ].xPeriod > xTasks[ uxI ].xDeadline )
+		{
+			ullLaxity = ullLaxity + ( ( uint64_t ) ( xTasks[ uxI ].xPeriod - xTasks[ uxI ].xDeadline ) * ( ullLo + 1U ) );
+		}
+
+		ullMaxDeadline = ( xTasks[ uxI ].xDeadline > ullMaxDeadline ) ? xTasks[ uxI ].xDeadline : ullMaxDeadline;
+		ullMaxBlocking = ( xTasks[ uxI ].xBlocking > ullMaxBlocking ) ? xTasks[ uxI ].xBlocking : ullMaxBlocking;
+		ullW = ullW + xTasks[ uxI ].xWcet;
+	}
+
+	ullW = ullW + ullMaxBlocking;
+
+	if( ullUtilizationLo > ullOne )
+	{
+		return 0U;
+	}
+
+	/* The bound assumes independent tasks. */
+	if( ( ullUtilizationHi < ullOne ) && ( ullMaxBlocking == 0U ) )
+	{
+		ullBound = ( ullLaxity + ( ullOne - ullUtilizationHi ) - 1U ) / ( ullOne - ullUtilizationHi );
+		ullBound = ( ( ullBound < ullMaxDeadline ) ? ullMaxDeadline : ullBound ) + 1U;
+	}
+
+	/* Synchronous busy period, stopped at the bound. */
+	do
+	{
+		uint64_t ullWork = ullMaxBlocking;
+
+		ullPrevious = ullW;
+
+		for( UBaseType_t uxI = 0; uxI < N; uxI++ )
+		{
+			ullWork = ullWork + ( ( ( ullPrevious + xTasks[ uxI ].xPeriod - 1U ) / xTasks[ uxI ].xPeriod ) * xTasks[ uxI ].xWcet );
+		}
+
+		if( ullWork >= ullBound )
+		{
+			/* 0 if the busy period does not fit in a TickType_t. */
+			return ( ullBound >= portMAX_DELAY ) ? 0U : ullBound;
+		}
+
+		ullW = ullWork;
+	}
+	while( ullW != ullPrevious );
+
+	return ullW + 1U;
+}
+
+/**
+ * EDF processor demand test, with QPA ("QPA: A Fast Schedulability Test for
+ * EDF", Zhang and Burns) over the deadlines before prvHstStaticDemandBound().
+ */
+template< UBaseType_t N >
+constexpr bool xHstStaticDemandSchedulable( const HstStaticTask_t ( &xTasks )[ N ] )
+{
+	const uint64_t ullL = prvHstStaticDemandBound( xTasks );
+	uint64_t ullMinDeadline = xTasks[ 0 ].xDeadline;
+
+	if( ullL == 0U )
+	{
+		return false;
+	}
+
+	for( UBaseType_t uxI = 1; uxI < N; uxI++ )
+	{
+		ullMinDeadline = ( xTasks[ uxI ].xDeadline < ullMinDeadline ) ? xTasks[ uxI ].xDeadline : ullMinDeadline;
+	}
+
+	uint64_t ullT = prvHstStaticPreviousDeadline( xTasks, ullL );
+	uint64_t ullH = prvHstStaticDemand( xTasks, ullT );
+
+	while( ( ullH <= ullT ) && ( ullH > ullMinDeadline ) )
+	{
+		ullT = ( ullH < ullT ) ? ullH : prvHstStaticPreviousDeadline( xTasks, ullT );
+		ullH = prvHstStaticDemand( xTasks, ullT );
+	}
+
+	return ( ullH <= ullMinDeadline );
+}
+
+/**
+ * Schedulability test of the policy: QPA under EDF, the response time
+ * analysis under fixed priorities.
+ */
+template< UBaseType_t N >
+constexpr bool xHstStaticSchedulable( const HstStaticTask_t ( &xTasks )[ N ] )
+{
+#if ( USE_QPA == 1 )
+	return xHstStaticDemandSchedulable( xTasks );
+#else
+	for( UBaseType_t uxI = 0; uxI < N; uxI++ )
+	{
+		if( xHstStaticWcrt( xTasks, uxI ) > xTasks[ uxI ].xDeadline )
+		{
+			return false;
+		}
+	}
+
+	return true;
+#endif
+}
+
+/**
+ * Promotion time of task uxIndex under dual priority, D - R, as the dp start
+ * logic computes it from the response time.
+ */
+template< UBaseType_t N >
+constexpr TickType_t xHstStaticPromotion( const HstStaticTask_t ( &xTasks )[ N ], UBaseType_t uxIndex )
+{
+	return xTasks[ uxIndex ].xDeadline - xHstStaticWcrt( xTasks, uxIndex );
+}
+
+/**
+ * Largest wcet of task uxIndex keeping the task set schedulable, the others
+ * unchanged, with a binary search over the test (sensitivity.c). The
+ * utilization can not exceed 1.
+ */
+template< UBaseType_t N >
+constexpr TickType_t xHstStaticWcetMax( const HstStaticTask_t ( &xTasks )[ N ], UBaseType_t uxIndex )
+{
+	HstStaticTask_t xProbe[ N ] = {};
+	uint64_t ullLo = xHstStaticSchedulable( xTasks ) ? xTasks[ uxIndex ].xWcet : 0U;
+	uint64_t ullHi = ( xTasks[ uxIndex ].xDeadline > xTasks[ uxIndex ].xBlocking ) ? ( xTasks[ uxIndex ].xDeadline - xTasks[ uxIndex ].xBlocking ) : 0U;
+
+	for( UBaseType_t uxI = 0; uxI < N; uxI++ )
+	{
+		xProbe[ uxI ] = xTasks[ uxI ];
+	}
+
+	ullHi = ( ullHi < ullLo ) ? ullLo : ullHi;
+
+	while( ullLo < ullHi )
+	{
+		const uint64_t ullMid = ullLo + ( ( ullHi - ullLo + 1U ) >> 1 );
+		uint64_t ullUtilization = 0U;
+
+		xProbe[ uxIndex ].xWcet = ( TickType_t ) ullMid;
+
+		/* Q32 utilization, floored as in sensitivity.c: the test decides at
+		 * U == 1 exactly. */
+		for( UBaseType_t uxI = 0; uxI < N; uxI++ )
+		{
+			ullUtilization = ullUtilization + ( ( ( uint64_t ) xProbe[ uxI ].xWcet << 32 ) / xProbe[ uxI ].xPeriod );
+		}
+
+		if( ( ullUtilization <= ( ( uint64_t ) 1U << 32 ) ) && xHstStaticSchedulable( xProbe ) )
+		{
+			ullLo = ullMid;
+		}
+		else
+		{
+			ullHi = ullMid - 1U;
+		}
+	}
+
+	return ( TickType_t ) ullLo;
+}
+
+/**
+ * Analysis tables of the task set, for vHstStaticSetTables(). Under EDF the
+ * task set is ordered by deadline, the tasks with equal deadlines in creation
+ * order, as the policy list.
+ */
+template< UBaseType_t N >
+constexpr HstStaticTables_t< N > xHstStaticTables( const HstStaticTask_t ( &xTasks )[ N ] )
+{
+	HstStaticTables_t< N > xTables = {};
+	UBaseType_t uxOrder[ N ] = {};
+
+	for( UBaseType_t uxI = 0; uxI < N; uxI++ )
+	{
+		UBaseType_t uxJ = uxI;
+
+#if ( USE_QPA == 1 )
+		/* Stable insertion by deadline. */
+		for( ; ( uxJ > 0 ) && ( xTasks[ uxOrder[ uxJ - 1 ] ].xDeadline > xTasks[ uxI ].xDeadline ); uxJ-- )
+		{
+			uxOrder[ uxJ ] = uxOrder[ uxJ - 1 ];
+		}
+#endif
+
+		uxOrder[ uxJ ] = uxI;
+	}
+
+	for( UBaseType_t uxI = 0; uxI < N; uxI++ )
+	{
+		const HstStaticTask_t & xTask = xTasks[ uxOrder[ uxI ] ];
+		HstTableEntry_t & xEntry = xTables.xEntries[ uxI ];
+
+		xEntry.xPeriod = xTask.xPeriod;
+		xEntry.xDeadline = xTask.xDeadline;
+		xEntry.xWcet = xTask.xWcet;
+		xEntry.xOffset = xTask.xOffset;
+		xEntry.xBlocking = xTask.xBlocking;
+#if ( USE_QPA == 1 )
+		xEntry.xWcrt = xTask.xDeadline;
+#else
+		xEntry.xWcrt = xHstStaticWcrt( xTasks, uxOrder[ uxI ] );
+#endif
+		xEntry.xWcetMax = xHstStaticWcetMax( xTasks, uxOrder[ uxI ] );
+		xEntry.xSlack = 0;
+		xEntry.xTtma = 0U;
+	}
+
+	return xTables;
+}
+
+/**
+ * Creates the tasks of the task set, in order, each with its index as the
+ * priority.
+ *
+ * @return pdFAIL if a task could not be created.
+ */
+template< UBaseType_t N >
+BaseType_t xHstStaticTaskSetCreate( const HstStaticTask_t ( &xTasks )[ N ], TaskFunction_t pxTaskCode, const uint16_t usStackDepth )
+{
+	for( UBaseType_t uxI = 0; uxI < N; uxI++ )
+	{
+		const HstStaticTask_t & xTask = xTasks[ uxI ];
+
+		if( xSchedulerTaskCreateWithOffset( pxTaskCode, xTask.pcName, usStackDepth, NULL, uxI, NULL, xTask.xPeriod, xTask.xDeadline, xTask.xWcet, xTask.xOffset ) != pdPASS )
+		{
+			return pdFAIL;
+		}
+	}
+
+	return pdPASS;
+}
+
+/**
+ * Makes vSchedulerInit() use the tables instead of analysing the task set.
+ */
+template< UBaseType_t N >
+void vHstStaticSetTables( const HstStaticTables_t< N > & xTables )
+{
+	/* Computed without the overheads. */
+	static const HstTableOverheads_t xOverheads = { 0U, 0U, 0U, 0U };
+
+	vSchedulerSetTables( xTables.xEntries, N, &xOverheads );
+}
@@ -0,0 +1,167 @@
+#include "FreeRTOS.h"
+#include "scheduler.h"
+#include "taskset.h"
+
+static BaseType_t prvTaskSetFill( List_t * pxList, UBaseType_t uxCount );
+
+HstTaskSet_t xHstTaskSet = { 0, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL, NULL };
+
+/* Number of tasks the arrays can hold. */
+static UBaseType_t uxCapacity = 0;
+
+BaseType_t xTaskSetBuild( List_t * pxList )
+{
+	UBaseType_t uxCount = 0;
+
+	ListItem_t * pxAppTasksListItem = listGET_HEAD_ENTRY( pxList );
+
+	/* Count the periodic tasks. */
+	while( listGET_END_MARKER( pxList ) != pxAppTasksListItem )
+	{
+		if( ( ( HstTCB_t * ) listGET_LIST_ITEM_OWNER( pxAppTasksListItem ) )->xHstTaskType == HST_PERIODIC )
+		{
+			uxCount++;
+		}
+
+		pxAppTasksListItem = listGET_NEXT( pxAppTasksListItem );
+	}
+
+	xHstTaskSet.uxCount = 0;
+
+	if( uxCount == 0 )
+	{
+		return pdPASS;
+	}
+
+	if( uxCount <= uxCapacity )
+	{
+		return prvTaskSetFill( pxList, uxCount );
+	}
+
+	if( xHstTaskSet.pxTask != NULL )
+	{
+		/* The block starts with the pointer array. */
+		vPortFree( xHstTaskSet.pxTask );
+		xHstTaskSet.pxTask = NULL;
+		uxCapacity = 0;
+	}
+
+	/* A single block, the pointer array first so every array is aligned. */
+	uint8_t *pucBlock = ( uint8_t * ) pvPortMalloc( uxCount * ( sizeof( HstTCB_t * ) + 8 * sizeof( TickType_t ) + sizeof( uint32_t ) + sizeof( BaseType_t ) ) );
+
+	if( pucBlock == NULL )
+	{
+		return pdFAIL;
+	}
+
+	xHstTaskSet.pxTask = ( HstTCB_t ** ) pucBlock;
+	pucBlock = pucBlock + uxCount * sizeof( HstTCB_t * );
+	xHstTaskSet.pxPeriod = ( TickType_t * ) pucBlock;
+	pucBlock = pucBlock + uxCount * sizeof( TickType_t );
+	xHstTaskSet.pxWcet = ( TickType_t * ) pucBlock;
+	pucBlock = pucBlock + uxCount * sizeof( TickType_t );
+	xHstTaskSet.pxDeadline = ( TickType_t * ) pucBlock;
+	pucBlock = pucBlock + uxCount * sizeof( TickType_t );
+	xHstTaskSet.pxWcrt = ( TickType_t * ) pucBlock;
+	pucBlock = pucBlock + uxCount * sizeof( TickType_t );
+	xHstTaskSet.pxBlocking = ( TickType_t * ) pucBlock;
+	pucBlock = pucBlock + uxCount * sizeof( TickType_t );
+	xHstTaskSet.pxOffset = ( TickType_t * ) pucBlock;
+	pucBlock = pucBlock + uxCount * sizeof( TickType_t );
+	xHstTaskSet.pxPhase = ( TickType_t * ) pucBlock;
+	pucBlock = pucBlock + uxCount * sizeof( TickType_t );
+	xHstTaskSet.pxCarry = ( TickType_t * ) pucBlock;
+	pucBlock = pucBlock + uxCount * sizeof( TickType_t );
+	xHstTaskSet.pulPeriodRecip = ( uint32_t * ) pucBlock;
+	pucBlock = pucBlock + uxCount * sizeof( uint32_t );
+	xHstTaskSet.pxSlack = ( BaseType_t * ) pucBlock;
+
+	uxCapacity = uxCount;
+
+	return prvTaskSetFill( pxList, uxCount );
+}
+
+void vTaskSetMove( UBaseType_t uxFrom, UBaseType_t uxTo )
+{
+	HstTCB_t * const pxTask = xHstTaskSet.pxTask[ uxFrom ];
+	const TickType_t xPeriod = xHstTaskSet.pxPeriod[ uxFrom ];
+	const uint32_t ulPeriodRecip = xHstTaskSet.pulPeriodRecip[ uxFrom ];
+	const TickType_t xWcet = xHstTaskSet.pxWcet[ uxFrom ];
+	const TickType_t xDeadline = xHstTaskSet.pxDeadline[ uxFrom ];
+	const TickType_t xWcrt = xHstTaskSet.pxWcrt[ uxFrom ];
+	const TickType_t xBlocking = xHstTaskSet.pxBlocking[ uxFrom ];
+	const TickType_t xOffset = xHstTaskSet.pxOffset[ uxFrom ];
+	const BaseType_t xSlack = xHstTaskSet.pxSlack[ uxFrom ];
+	UBaseType_t uxI = uxFrom;
+
+	while( uxI != uxTo )
+	{
+		const UBaseType_t uxNext = ( uxTo > uxFrom ) ? ( uxI + 1 ) : ( uxI - 1 );
+
+		xHstTaskSet.pxTask[ uxI ] = xHstTaskSet.pxTask[ uxNext ];
+		xHstTaskSet.pxPeriod[ uxI ] = xHstTaskSet.pxPeriod[ uxNext ];
+		xHstTaskSet.pulPeriodRecip[ uxI ] = xHstTaskSet.pulPeriodRecip[ uxNext ];
+		xHstTaskSet.pxWcet[ uxI ] = xHstTaskSet.pxWcet[ uxNext ];
+		xHstTaskSet.pxDeadline[ uxI ] = xHstTaskSet.pxDeadline[ uxNext ];
+		xHstTaskSet.pxWcrt[ uxI ] = xHstTaskSet.pxWcrt[ uxNext ];
+		xHstTaskSet.pxBlocking[ uxI ] = xHstTaskSet.pxBlocking[ uxNext ];
+		xHstTaskSet.pxOffset[ uxI ] = xHstTaskSet.pxOffset[ uxNext ];
+		xHstTaskSet.pxSlack[ uxI ] = xHstTaskSet.pxSlack[ uxNext ];
+		xHstTaskSet.pxTask[ uxI ]->uxIndex = uxI;
+
+		uxI = uxNext;
+	}
+
+	xHstTaskSet.pxTask[ uxTo ] = pxTask;
+	xHstTaskSet.pxPeriod[ uxTo ] = xPeriod;
+	xHstTaskSet.pulPeriodRecip[ uxTo ] = ulPeriodRecip;
+	xHstTaskSet.pxWcet[ uxTo ] = xWcet;
+	xHstTaskSet.pxDeadline[ uxTo ] = xDeadline;
+	xHstTaskSet.pxWcrt[ uxTo ] = xWcrt;
+	xHstTaskSet.pxBlocking[ uxTo ] = xBlocking;
+	xHstTaskSet.pxOffset[ uxTo ] = xOffset;
+	xHstTaskSet.pxSlack[ uxTo ] = xSlack;
+	pxTask->uxIndex = uxTo;
+}
+
+/**
+ * Copies the periodic tasks in pxList into the arrays.
+ */
+static BaseType_t prvTaskSetFill( List_t * pxList, UBaseType_t uxCount )
+{
+	ListItem_t * pxAppTasksListItem;
+	UBaseType_t uxI;
+
+	uxI = 0;
+	pxAppTasksListItem = listGET_HEAD_ENTRY( pxList );
+
+	while( listGET_END_MARKER( pxList ) != pxAppTasksListItem )
+	{
+		HstTCB_t *pxTask = ( HstTCB_t * ) listGET_LIST_ITEM_OWNER( pxAppTasksListItem );
+
+		if( pxTask->xHstTaskType == HST_PERIODIC )
+		{
+			pxTask->uxIndex = uxI;
+
+			xHstTaskSet.pxTask[ uxI ] = pxTask;
+			xHstTaskSet.pxPeriod[ uxI ] = pxTask->xPeriod;
+			xHstTaskSet.pulPeriodRecip[ uxI ] = pxTask->ulPeriodRecip;
+			xHstTaskSet.pxWcet[ uxI ] = pxTask->xWcet;
+			xHstTaskSet.pxDeadline[ uxI ] = pxTask->xDeadline;
+			xHstTaskSet.pxWcrt[ uxI ] = pxTask->xWcrt;
+			xHstTaskSet.pxBlocking[ uxI ] = 0;
+			xHstTaskSet.pxOffset[ uxI ] = pxTask->xOffset;
+			xHstTaskSet.pxPhase[ uxI ] = 0;
+			xHstTaskSet.pxCarry[ uxI ] = 0;
+			xHstTaskSet.pxSlack[ uxI ] = 0;
+
+			uxI++;
+		}
+
+		pxAppTasksListItem = listGET_NEXT( pxAppTasksListItem );
+	}
+
+	xHstTaskSet.uxCount = uxCount;
+
+	return pdPASS;
+}
@@ -0,0 +1,57 @@
+#include "FreeRTOS.h"
+
+/**
+ * Structure-of-arrays copy of the periodic task set, in priority order (index
+ * 0 is the highest priority task). The higher priority tasks of the task at
+ * index i are the ones at indexes [0, i).
+ *
+ * The response time and slack analyses iterate these arrays with indexed
+ * loops, instead of walking pxAllTasksList and dereferencing each HstTCB_t
+ * and its vExt extension.
+ */
+typedef struct
+{
+	UBaseType_t uxCount;        /* Number of periodic tasks. */
+	HstTCB_t **pxTask;          /* TCBe of each task. */
+	TickType_t *pxPeriod;       /* Periods. */
+	uint32_t *pulPeriodRecip;   /* Period reciprocals, for U_CEIL_R/U_FLOOR_R. */
+	TickType_t *pxWcet;         /* Worst case execution times. */
+	TickType_t *pxDeadline;     /* Relative deadlines. */
+	TickType_t *pxWcrt;         /* Worst case response times. */
+	TickType_t *pxBlocking;     /* Blocking by lower priority tasks (resource.h). */
+	TickType_t *pxOffset;       /* Release offsets. */
+	TickType_t *pxPhase;        /* Scratch for the offset analysis (wcrt.c). */
+	TickType_t *pxCarry;        /* Scratch for the offset analysis (wcrt.c). */
+	BaseType_t *pxSlack;        /* Slack counters (slack stealing). */
+	const HstTableEntry_t *pxTable;  /* Precomputed analysis, NULL if analysed at boot. */
+} HstTaskSet_t;
+
+extern HstTaskSet_t xHstTaskSet;
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * Builds xHstTaskSet from the periodic tasks in pxList, which must be ordered
+ * by priority, and sets the uxIndex member of each task. Called by
+ * vSchedulerInit(), after all the tasks were created. The arrays are
+ * allocated by the first call, later calls refill them.
+ *
+ * @param pxList the policy list of all the periodic tasks.
+ * @return pdFAIL if the arrays could not be allocated.
+ */
+BaseType_t xTaskSetBuild( List_t * pxList );
+
+/**
+ * Moves the task at uxFrom to uxTo, shifting the tasks in between by one
+ * position, and updates their uxIndex members. Used to try priority orders.
+ *
+ * @param uxFrom
+ * @param uxTo
+ */
+void vTaskSetMove( UBaseType_t uxFrom, UBaseType_t uxTo );
+
+#if defined (__cplusplus)
+}
+#endif
@@ -1,78 +1,797 @@
-#include "wcrt.h"
+#include "FreeRTOS.h"
 #include "scheduler.h"
-#include "scheduler_logic.h"  // pxAllTasksList
-#include "utils.h"            // U_CEIL, U_FLOOR
+#include "scheduler_logic.h"  // USE_EXACT_WCRT
+#include "wcrt.h"
+#include "taskset.h"          // xHstTaskSet
+#include "resource.h"         // xResourceBlocking
+#include "utils.h"            // U_CEIL_R
+
+/* Utilizations and overheads are Q16 fixed-point numbers: 1.0 is wcrtONE. */
+#define wcrtONE    ( ( uint64_t ) 0x10000 )
+
+static void prvWcrtUtilization( UBaseType_t uxIndex, uint32_t *pulLo, uint32_t *pulHi );
+static BaseType_t prvWcrtHyperbolic( void );
+static TickType_t prvWcrtExact( UBaseType_t uxIndex, TickType_t xStart, TickType_t *pxFirstJob );
+static TickType_t prvWcrtOffsets( UBaseType_t uxIndex );
+static TickType_t prvWcrtGcd( TickType_t xA, TickType_t xB );
+static BaseType_t prvWcrtAssignable( UBaseType_t uxLevel, uint64_t ullUtilizationLo, uint64_t ullUtilizationHi, uint64_t ullInterference, uint64_t ullWcetSum, BaseType_t xPhased );
+static void prvWcrtDefaultOverheads( void );
+static uint64_t prvWcrtOverhead( uint32_t ulCycles, uint64_t ullCyclesPerTick );
+
+/* Layer that decided the last analysis. */
+static WcrtLayer_t xLayer = WCRT_LAYER_NONE;
+
+/* Fixed point iterations of the last analysis. */
+static UBaseType_t uxIterations = 0;
+
+/* Overheads in Q16 ticks: per tick, per job dispatch and per preemption. */
+static uint64_t ullTickOverhead = 0U;
+static uint64_t ullDispatchOverhead = 0U;
+static uint64_t ullPreemptionOverhead = 0U;
+
+/* pdTRUE if any overhead is not zero. */
+static BaseType_t xOverheads = pdFALSE;
+
+/* pdTRUE once the overheads were set, from the configuration or with
+ * vWcrtSetOverheads(). */
+static BaseType_t xOverheadsSet = pdFALSE;
 
 /**
- * RTA
- * "Improved Response-Time Analysis Calculations"
- * http://doi.ieeecomputersociety.org/10.1109/REAL.1998.739773
+ * Layered schedulability test. The cheap whole task set tests run first, then
+ * for each task the response time bounds from
+ * "A Response-Time Bound in Fixed-Priority Scheduling with Arbitrary Deadlines"
+ * (Bini, Nguyen, Richard, Baruah), and only the tasks the bounds can not
+ * decide are analysed exactly, starting from their largest lower bound.
+ *
+ * The bounds use one 64 bit division per task, the exact analysis none.
+ *
+ * The overheads only increase the response times, so the lower bounds stay
+ * valid. The hyperbolic bound and the upper bounds assume a free scheduler, so
+ * they are skipped when the overheads are not zero. The blocking term B of
+ * each task (resource.h) is added to its own workload; the hyperbolic bound is
+ * skipped when any task can be blocked.
+ *
+ * With release offsets the synchronous release is no longer guaranteed, so
+ * every test above still accepts, but only the offset analysis
+ * (prvWcrtOffsets()) may reject a task with D <= T. Where the exact analysis
+ * runs, the smaller of both response times is kept.
  */
 BaseType_t xWcrtCalculateTasksWcrt( void )
 {
-	TickType_t xW = 0U;
+	return xWcrtCalculateTasksWcrtFrom( 0 );
+}
+
+/**
+ * The tasks above uxFrom only add their terms to the sums of the bounds. The
+ * warm start of task uxFrom is lost, its other lower bounds still hold.
+ */
+BaseType_t xWcrtCalculateTasksWcrtFrom( UBaseType_t uxFrom )
+{
+	const UBaseType_t uxCount = xHstTaskSet.uxCount;
+	const TickType_t * const pxWcet = xHstTaskSet.pxWcet;
+	const TickType_t * const pxDeadline = xHstTaskSet.pxDeadline;
+	const TickType_t * const pxBlocking = xHstTaskSet.pxBlocking;
+
+	uint64_t ullUtilizationLo = 0U;   // Sum of the utilization lower bounds.
+	uint64_t ullUtilizationHi = 0U;   // Sum of the utilization upper bounds.
+	uint64_t ullInterference = 0U;    // Sum of C * ( 1 - U ), Q16, rounded up.
+	uint64_t ullWcetSum = 0U;         // Sum of the wcets.
+	TickType_t xLowerBound = 0U;      // Lower bound (or exact value) of the first job of the previous task.
+	TickType_t xPreviousBlocking = 0U;
+	BaseType_t xBlocking = pdFALSE;   // pdTRUE if any task can be blocked.
+	BaseType_t xPhased = pdFALSE;     // pdTRUE if any task has a release offset.
 
-	ListItem_t * pxAppTasksListItem = listGET_HEAD_ENTRY( pxAllTasksList );
+	BaseType_t xHyperbolic;
+	UBaseType_t uxI;
 
-	HstTCB_t *pxTask = ( HstTCB_t * ) listGET_LIST_ITEM_OWNER( pxAppTasksListItem );
+	xLayer = WCRT_LAYER_NONE;
+	uxIterations = 0;
 
-	/* First task WCRT. */
-	TickType_t xT = pxTask->xWcet;
-    pxTask->xWcrt = xT;
+	prvWcrtDefaultOverheads();
 
-    /* Check first task deadline. */
-    if( pxTask->xWcrt > pxTask->xPeriod )
-    {
-        return pdFALSE;
-    }
+	if( uxCount == 0 )
+	{
+		return pdTRUE;
+	}
+
+	/* Layer 1: total utilization. */
+	for( uxI = 0; uxI < uxCount; uxI++ )
+	{
+		uint32_t ulLo, ulHi;
+
+		prvWcrtUtilization( uxI, &ulLo, &ulHi );
+		ullUtilizationLo = ullUtilizationLo + ulLo;
+
+		if( pxBlocking[ uxI ] > 0U )
+		{
+			xBlocking = pdTRUE;
+		}
+
+		if( xHstTaskSet.pxOffset[ uxI ] > 0U )
+		{
+			xPhased = pdTRUE;
+		}
+	}
+
+	if( ullUtilizationLo > wcrtONE )
+	{
+		xLayer = WCRT_LAYER_UTILIZATION;
+		return pdFALSE;
+	}
+
+	/* Layer 2: hyperbolic bound. */
+	xHyperbolic = ( ( xOverheads == pdFALSE ) && ( xBlocking == pdFALSE ) ) ? prvWcrtHyperbolic() : pdFALSE;
+
+	if( xHyperbolic == pdTRUE )
+	{
+		xLayer = WCRT_LAYER_HYPERBOLIC;
+	}
+	else
+	{
+		xLayer = WCRT_LAYER_BOUNDS;
+	}
 
-    /* Next task. */
-    pxAppTasksListItem = listGET_NEXT( pxAppTasksListItem );
+	/* Layers 3 and 4, also computing xWcrt when the set was already accepted. */
+	ullUtilizationLo = 0U;
 
-    /* Process all the periodic tasks in xTasks. */
-    while( listGET_END_MARKER( pxAllTasksList ) != pxAppTasksListItem )
+	for( uxI = 0; uxI < uxCount; uxI++ )
 	{
-    	pxTask = ( HstTCB_t * ) listGET_LIST_ITEM_OWNER( pxAppTasksListItem );
+		const TickType_t xC = pxWcet[ uxI ];
+		const TickType_t xB = pxBlocking[ uxI ];
+		const BaseType_t xOffsetAnalysis = ( ( xPhased == pdTRUE ) && ( pxDeadline[ uxI ] <= xHstTaskSet.pxPeriod[ uxI ] ) ) ? pdTRUE : pdFALSE;
+		TickType_t xUpperBound = portMAX_DELAY;
+		TickType_t xWcrt;
+		uint32_t ulLo, ulHi;
+
+		if( uxI < uxFrom )
+		{
+			prvWcrtUtilization( uxI, &ulLo, &ulHi );
+
+			ullUtilizationLo = ullUtilizationLo + ulLo;
+			ullUtilizationHi = ullUtilizationHi + ulHi;
+			ullInterference = ullInterference + ( ( uint64_t ) xC * ( wcrtONE - ( ulLo < wcrtONE ? ulLo : wcrtONE ) ) );
+			ullWcetSum = ullWcetSum + xC;
+			continue;
+		}
 
-		xT = xT + pxTask->xWcet;
+		/* Lower bounds: the previous task plus C (Sjodin and Hansson), valid
+		 * only if this task can not be blocked less than the previous one; the
+		 * first job of every higher priority task plus C + B, and
+		 * ( C + B ) / ( 1 - U ). */
+		uint64_t ullLowerBound = ( xB >= xPreviousBlocking ) ? ( ( uint64_t ) xLowerBound + xC ) : 0U;
 
-		while( xT <= pxTask->xDeadline )
+		if( ( ullWcetSum + xC + xB ) > ullLowerBound )
 		{
-			xW = 0;
+			ullLowerBound = ullWcetSum + xC + xB;
+		}
 
-			/* Calculates the workload of the higher priority tasks than pxTask. */
-			ListItem_t * pxAppTaskHigherPrioListItem = listGET_HEAD_ENTRY( pxAllTasksList );
-			do
+		if( ullUtilizationLo < wcrtONE )
+		{
+			const uint64_t ullDenominator = wcrtONE - ullUtilizationLo;
+			const uint64_t ullBound = ( ( ( uint64_t ) ( xC + xB ) * wcrtONE ) + ullDenominator - 1U ) / ullDenominator;
+
+			if( ullBound > ullLowerBound )
 			{
-				HstTCB_t *pxHigherPrioTask = ( HstTCB_t * ) listGET_LIST_ITEM_OWNER( pxAppTaskHigherPrioListItem );
+				ullLowerBound = ullBound;
+			}
+		}
+
+		if( ( ullLowerBound > pxDeadline[ uxI ] ) && ( xOffsetAnalysis == pdFALSE ) )
+		{
+			return pdFALSE;
+		}
 
-				xW = xW + ( U_CEIL( xT, pxHigherPrioTask->xPeriod ) * pxHigherPrioTask->xWcet );
+		xLowerBound = ( ullLowerBound < portMAX_DELAY ) ? ( TickType_t ) ullLowerBound : portMAX_DELAY;
 
-				pxAppTaskHigherPrioListItem = listGET_NEXT( pxAppTaskHigherPrioListItem );
+		prvWcrtUtilization( uxI, &ulLo, &ulHi );
+
+		/* Upper bound ( C + B + sum( C_j * ( 1 - U_j ) ) ) / ( 1 - U ). It also
+		 * bounds the later jobs of a busy period, when D > T, as long as the
+		 * utilization up to this task does not exceed 1. */
+		if( ( xOverheads == pdFALSE ) && ( ullUtilizationHi < wcrtONE ) && ( ( pxDeadline[ uxI ] <= xHstTaskSet.pxPeriod[ uxI ] ) || ( ( ullUtilizationHi + ulHi ) <= wcrtONE ) ) )
+		{
+			const uint64_t ullNumerator = ( ( uint64_t ) ( xC + xB ) * wcrtONE ) + ullInterference;
+			const uint64_t ullDenominator = wcrtONE - ullUtilizationHi;
+			const uint64_t ullBound = ( ullNumerator + ullDenominator - 1U ) / ullDenominator;
+
+			if( ullBound < portMAX_DELAY )
+			{
+				xUpperBound = ( TickType_t ) ullBound;
 			}
-			while( pxAppTaskHigherPrioListItem != pxAppTasksListItem );
+		}
+
+		if( ( USE_EXACT_WCRT == 0 ) && ( xUpperBound <= pxDeadline[ uxI ] ) )
+		{
+			xWcrt = xUpperBound;
+		}
+		else if( ( USE_EXACT_WCRT == 0 ) && ( xHyperbolic == pdTRUE ) )
+		{
+			/* Accepted: the response time does not exceed the period, which
+			 * does not exceed the deadline. */
+			xWcrt = xHstTaskSet.pxPeriod[ uxI ];
+		}
+		else
+		{
+			TickType_t xFirstJob = xLowerBound;
 
-			xW = xW + pxTask->xWcet;
+			xWcrt = ( xLowerBound <= pxDeadline[ uxI ] ) ? prvWcrtExact( uxI, xLowerBound, &xFirstJob ) : portMAX_DELAY;
 
-			if( xT == xW )
+			if( ( xHyperbolic == pdFALSE ) && ( xUpperBound > pxDeadline[ uxI ] ) )
 			{
-				break;
+				/* The bounds did not decide this task. */
+				xLayer = WCRT_LAYER_EXACT;
 			}
-			else
+
+			if( xOffsetAnalysis == pdTRUE )
 			{
-				xT = xW;
+				const TickType_t xOffsetWcrt = prvWcrtOffsets( uxI );
+
+				if( xOffsetWcrt < xWcrt )
+				{
+					xWcrt = xOffsetWcrt;
+					xLayer = WCRT_LAYER_OFFSETS;
+				}
 			}
+
+			if( xWcrt > pxDeadline[ uxI ] )
+			{
+				return pdFALSE;
+			}
+
+			/* Warm start for the next task. */
+			xLowerBound = xFirstJob;
 		}
 
-		if( xT > pxTask->xDeadline )
+		xHstTaskSet.pxWcrt[ uxI ] = xWcrt;
+		xHstTaskSet.pxTask[ uxI ]->xWcrt = xWcrt;
+
+		/* Task i interferes with the lower priority tasks. */
+		ullUtilizationLo = ullUtilizationLo + ulLo;
+		ullUtilizationHi = ullUtilizationHi + ulHi;
+		ullInterference = ullInterference + ( ( uint64_t ) xC * ( wcrtONE - ( ulLo < wcrtONE ? ulLo : wcrtONE ) ) );
+		ullWcetSum = ullWcetSum + xC;
+		xPreviousBlocking = xB;
+	}
+
+	return pdTRUE;
+}
+
+/**
+ * Audsley's optimal priority assignment ("Optimal Priority Assignment and
+ * Feasibility of Static Priority Tasks With Arbitrary Start Times"). From the
+ * lowest priority up, a task that meets its deadline below every unassigned
+ * task takes the priority. The test of a task depends only on the set of
+ * tasks above it, not on their order (the blocking and offset terms too), so
+ * if any priority order is schedulable, one is found.
+ *
+ * The unassigned tasks are kept in deadline monotonic order and tried from
+ * the longest deadline, the optimal order for D <= T without offsets or
+ * blocking, so usually the first candidate of each level passes. The sums of
+ * the bounds are kept for the unassigned tasks, and each candidate subtracts
+ * its own terms, so the bounds of a candidate cost O(1), and only the
+ * candidates they can not decide run the response time analysis.
+ */
+BaseType_t xWcrtAssignPriorities( void )
+{
+	const UBaseType_t uxCount = xHstTaskSet.uxCount;
+	const TickType_t * const pxWcet = xHstTaskSet.pxWcet;
+	const TickType_t * const pxDeadline = xHstTaskSet.pxDeadline;
+
+	uint64_t ullUtilizationLo = 0U;
+	uint64_t ullUtilizationHi = 0U;
+	uint64_t ullInterference = 0U;
+	uint64_t ullWcetSum = 0U;
+	BaseType_t xPhased = pdFALSE;
+	UBaseType_t uxI, uxJ, uxLevel;
+
+	uxIterations = 0;
+
+	prvWcrtDefaultOverheads();
+
+	/* Deadline monotonic order (stable insertion sort). */
+	for( uxI = 1; uxI < uxCount; uxI++ )
+	{
+		for( uxJ = uxI; ( uxJ > 0 ) && ( pxDeadline[ uxJ - 1 ] > pxDeadline[ uxI ] ); uxJ-- )
+		{
+		}
+
+		if( uxJ != uxI )
+		{
+			vTaskSetMove( uxI, uxJ );
+		}
+	}
+
+	for( uxI = 0; uxI < uxCount; uxI++ )
+	{
+		uint32_t ulLo, ulHi;
+
+		prvWcrtUtilization( uxI, &ulLo, &ulHi );
+		ullUtilizationLo = ullUtilizationLo + ulLo;
+		ullUtilizationHi = ullUtilizationHi + ulHi;
+		ullInterference = ullInterference + ( ( uint64_t ) pxWcet[ uxI ] * ( wcrtONE - ( ulLo < wcrtONE ? ulLo : wcrtONE ) ) );
+		ullWcetSum = ullWcetSum + pxWcet[ uxI ];
+
+		if( xHstTaskSet.pxOffset[ uxI ] > 0U )
 		{
+			xPhased = pdTRUE;
+		}
+
+		/* The response times are not known yet: the jobs carried in by the
+		 * offset analysis are bounded with the deadlines, which hold once the
+		 * assignment is found. */
+		xHstTaskSet.pxWcrt[ uxI ] = pxDeadline[ uxI ];
+	}
+
+	if( ullUtilizationLo > wcrtONE )
+	{
+		return pdFALSE;
+	}
+
+	for( uxLevel = uxCount; uxLevel-- > 0; )
+	{
+		BaseType_t xAssigned = pdFALSE;
+		uint32_t ulLo, ulHi;
+
+		for( uxI = uxLevel + 1; ( xAssigned == pdFALSE ) && ( uxI-- > 0 ); )
+		{
+			vTaskSetMove( uxI, uxLevel );
+
+			prvWcrtUtilization( uxLevel, &ulLo, &ulHi );
+
+			xAssigned = prvWcrtAssignable( uxLevel,
+					ullUtilizationLo - ulLo,
+					ullUtilizationHi - ulHi,
+					ullInterference - ( ( uint64_t ) pxWcet[ uxLevel ] * ( wcrtONE - ( ulLo < wcrtONE ? ulLo : wcrtONE ) ) ),
+					ullWcetSum - pxWcet[ uxLevel ],
+					xPhased );
+
+			if( xAssigned == pdFALSE )
+			{
+				vTaskSetMove( uxLevel, uxI );
+			}
+		}
+
+		if( xAssigned == pdFALSE )
+		{
+			/* No task can take this priority. */
 			return pdFALSE;
 		}
 
-		pxTask->xWcrt = xT;
+		ullUtilizationLo = ullUtilizationLo - ulLo;
+		ullUtilizationHi = ullUtilizationHi - ulHi;
+		ullInterference = ullInterference - ( ( uint64_t ) pxWcet[ uxLevel ] * ( wcrtONE - ( ulLo < wcrtONE ? ulLo : wcrtONE ) ) );
+		ullWcetSum = ullWcetSum - pxWcet[ uxLevel ];
+	}
+
+	return pdTRUE;
+}
+
+/**
+ * Whether the task at uxLevel meets its deadline below the tasks [0, uxLevel),
+ * whose sums are given. The same layers as xWcrtCalculateTasksWcrt(), for one
+ * task.
+ */
+static BaseType_t prvWcrtAssignable( UBaseType_t uxLevel, uint64_t ullUtilizationLo, uint64_t ullUtilizationHi, uint64_t ullInterference, uint64_t ullWcetSum, BaseType_t xPhased )
+{
+	const TickType_t xC = xHstTaskSet.pxWcet[ uxLevel ];
+	const TickType_t xD = xHstTaskSet.pxDeadline[ uxLevel ];
+	const TickType_t xB = xResourceBlocking( uxLevel );
+	const BaseType_t xOffsetAnalysis = ( ( xPhased == pdTRUE ) && ( xD <= xHstTaskSet.pxPeriod[ uxLevel ] ) ) ? pdTRUE : pdFALSE;
+	uint64_t ullLowerBound = ullWcetSum + xC + xB;
+	TickType_t xFirstJob;
+	uint32_t ulLo, ulHi;
+
+	xHstTaskSet.pxBlocking[ uxLevel ] = xB;
+
+	if( ullUtilizationLo >= wcrtONE )
+	{
+		/* The higher priority tasks leave no time. */
+		return pdFALSE;
+	}
+
+	{
+		const uint64_t ullDenominator = wcrtONE - ullUtilizationLo;
+		const uint64_t ullBound = ( ( ( uint64_t ) ( xC + xB ) * wcrtONE ) + ullDenominator - 1U ) / ullDenominator;
+
+		if( ullBound > ullLowerBound )
+		{
+			ullLowerBound = ullBound;
+		}
+	}
+
+	if( ( ullLowerBound > xD ) && ( xOffsetAnalysis == pdFALSE ) )
+	{
+		return pdFALSE;
+	}
+
+	prvWcrtUtilization( uxLevel, &ulLo, &ulHi );
+
+	if( ( xOverheads == pdFALSE ) && ( ullUtilizationHi < wcrtONE ) && ( ( xD <= xHstTaskSet.pxPeriod[ uxLevel ] ) || ( ( ullUtilizationHi + ulHi ) <= wcrtONE ) ) )
+	{
+		const uint64_t ullNumerator = ( ( uint64_t ) ( xC + xB ) * wcrtONE ) + ullInterference;
+		const uint64_t ullDenominator = wcrtONE - ullUtilizationHi;
+
+		if( ( ( ullNumerator + ullDenominator - 1U ) / ullDenominator ) <= xD )
+		{
+			return pdTRUE;
+		}
+	}
+
+	if( ( ullLowerBound <= xD ) && ( prvWcrtExact( uxLevel, ( TickType_t ) ullLowerBound, &xFirstJob ) <= xD ) )
+	{
+		return pdTRUE;
+	}
+
+	return ( ( xOffsetAnalysis == pdTRUE ) && ( prvWcrtOffsets( uxLevel ) <= xD ) ) ? pdTRUE : pdFALSE;
+}
+
+/**
+ * Applies the configured overheads, unless vWcrtSetOverheads() was called.
+ */
+static void prvWcrtDefaultOverheads( void )
+{
+	if( xOverheadsSet == pdFALSE )
+	{
+		vWcrtSetOverheads( configHST_TICK_OVERHEAD_CYCLES, configHST_DISPATCH_OVERHEAD_CYCLES, configHST_PREEMPTION_OVERHEAD_CYCLES );
+	}
+}
+
+WcrtLayer_t xWcrtGetLayer( void )
+{
+	return xLayer;
+}
+
+/**
+ * Approximate response time analysis with release offsets, for D <= T.
+ *
+ * Consider a job of task i released at r. A higher priority task j releases
+ * its jobs at O_j + k * T_j, and task i at O_i + k * T_i, so the distance
+ * from r to the next release of j is congruent to O_j - O_i modulo
+ * g = gcd( T_i, T_j ) ("Using offset information to analyse static priority
+ * pre-emptively scheduled task sets", Tindell). Then:
+ *
+ * - the first job of j released at or after r comes at least
+ *   phase_j = ( O_j - O_i ) mod g after r;
+ * - the last job of j released before r comes at least g - phase_j before
+ *   r, and jobs of j pending at r were released less than R_j before it.
+ *
+ * The job of i completes at the least fixed point of
+ *
+ *     w = B + C + sum( ( carry_j + ceil( ( w - phase_j ) / T_j ) ) * C_j )
+ *
+ * where carry_j = ceil( ( R_j - ( g - phase_j ) ) / T_j ) jobs of j may be
+ * pending at r, and the ceiling counts 0 jobs while w <= phase_j. With
+ * synchronous offsets the phases are 0 and no job is carried in, which is the
+ * classic analysis. The carry-in makes it pessimistic for some task sets, so
+ * the caller keeps the smaller of this and the synchronous response time.
+ *
+ * The phases need one gcd per pair of tasks, before the fixed point
+ * iterations, which do not divide.
+ *
+ * @param uxIndex task to analyse. The response times of the tasks [0, uxIndex)
+ * must be known.
+ * @return an upper bound of the worst case response time, or a value above
+ * the deadline.
+ */
+static TickType_t prvWcrtOffsets( UBaseType_t uxIndex )
+{
+	const TickType_t * const pxPeriod = xHstTaskSet.pxPeriod;
+	const uint32_t * const pulPeriodRecip = xHstTaskSet.pulPeriodRecip;
+	const TickType_t * const pxWcet = xHstTaskSet.pxWcet;
+	const TickType_t * const pxOffset = xHstTaskSet.pxOffset;
+	TickType_t * const pxPhase = xHstTaskSet.pxPhase;
+	TickType_t * const pxCarry = xHstTaskSet.pxCarry;
+	const TickType_t xDeadline = xHstTaskSet.pxDeadline[ uxIndex ];
+
+	uint64_t ullWork = ( uint64_t ) pxWcet[ uxIndex ] + xHstTaskSet.pxBlocking[ uxIndex ];
+	uint32_t ulCarried = 0U;
+	TickType_t xT;
+	UBaseType_t uxJ;
+
+	for( uxJ = 0; uxJ < uxIndex; uxJ++ )
+	{
+		const TickType_t xG = prvWcrtGcd( pxPeriod[ uxIndex ], pxPeriod[ uxJ ] );
+		const TickType_t xPhase = ( ( pxOffset[ uxJ ] % xG ) + xG - ( pxOffset[ uxIndex ] % xG ) ) % xG;
+		const TickType_t xBefore = xG - xPhase;
+		const TickType_t xWcrt = xHstTaskSet.pxWcrt[ uxJ ];
+
+		pxPhase[ uxJ ] = xPhase;
+		pxCarry[ uxJ ] = ( xWcrt > xBefore ) ? U_CEIL_R( xWcrt - xBefore, pxPeriod[ uxJ ], pulPeriodRecip[ uxJ ] ) : 0U;
+
+		ullWork = ullWork + ( ( uint64_t ) pxCarry[ uxJ ] * pxWcet[ uxJ ] );
+		ulCarried = ulCarried + pxCarry[ uxJ ];
+	}
+
+	if( ullWork > xDeadline )
+	{
+		return portMAX_DELAY;
+	}
+
+	xT = ( TickType_t ) ullWork;
+
+	for( ;; )
+	{
+		uint64_t ullW = ullWork;
+		uint32_t ulPreemptions = ulCarried;
+
+		uxIterations++;
+
+		for( uxJ = 0; uxJ < uxIndex; uxJ++ )
+		{
+			if( xT > pxPhase[ uxJ ] )
+			{
+				const TickType_t xJobs = U_CEIL_R( xT - pxPhase[ uxJ ], pxPeriod[ uxJ ], pulPeriodRecip[ uxJ ] );
+
+				ullW = ullW + ( ( uint64_t ) xJobs * pxWcet[ uxJ ] );
+				ulPreemptions = ulPreemptions + xJobs;
+			}
+		}
+
+		if( xOverheads == pdTRUE )
+		{
+			ullW = ullW + xWcrtGetOverhead( xT, 1U + ulPreemptions, ulPreemptions );
+		}
+
+		if( ullW > xDeadline )
+		{
+			return portMAX_DELAY;
+		}
+
+		if( ullW == xT )
+		{
+			return xT;
+		}
+
+		xT = ( TickType_t ) ullW;
+	}
+}
+
+static TickType_t prvWcrtGcd( TickType_t xA, TickType_t xB )
+{
+	while( xB != 0U )
+	{
+		const TickType_t xR = xA % xB;
+
+		xA = xB;
+		xB = xR;
+	}
+
+	return xA;
+}
+
+UBaseType_t uxWcrtGetIterations( void )
+{
+	return uxIterations;
+}
+
+void vWcrtSetOverheads( uint32_t ulTickCycles, uint32_t ulDispatchCycles, uint32_t ulPreemptionCycles )
+{
+	const uint64_t ullCyclesPerTick = ( uint64_t ) ( configCPU_CLOCK_HZ / configTICK_RATE_HZ );
+
+	ullTickOverhead = prvWcrtOverhead( ulTickCycles, ullCyclesPerTick );
+	ullDispatchOverhead = prvWcrtOverhead( ulDispatchCycles, ullCyclesPerTick );
+	ullPreemptionOverhead = prvWcrtOverhead( ulPreemptionCycles, ullCyclesPerTick );
+
+	xOverheads = ( ( ulTickCycles | ulDispatchCycles | ulPreemptionCycles ) != 0 ) ? pdTRUE : pdFALSE;
+	xOverheadsSet = pdTRUE;
+}
+
+BaseType_t xWcrtSameOverheads( uint32_t ulTickCycles, uint32_t ulDispatchCycles, uint32_t ulPreemptionCycles, uint32_t ulCpuClockHz )
+{
+	uint64_t ullCyclesPerTick;
+
+	prvWcrtDefaultOverheads();
+
+	if( ( ulTickCycles | ulDispatchCycles | ulPreemptionCycles ) == 0U )
+	{
+		return ( xOverheads == pdFALSE ) ? pdTRUE : pdFALSE;
+	}
+
+	if( ( xOverheads == pdFALSE ) || ( ulCpuClockHz < configTICK_RATE_HZ ) )
+	{
+		return pdFALSE;
+	}
+
+	ullCyclesPerTick = ( uint64_t ) ( ulCpuClockHz / configTICK_RATE_HZ );
+
+	return ( ( prvWcrtOverhead( ulTickCycles, ullCyclesPerTick ) == ullTickOverhead ) &&
+			 ( prvWcrtOverhead( ulDispatchCycles, ullCyclesPerTick ) == ullDispatchOverhead ) &&
+			 ( prvWcrtOverhead( ulPreemptionCycles, ullCyclesPerTick ) == ullPreemptionOverhead ) ) ? pdTRUE : pdFALSE;
+}
+
+/**
+ * Rounded up, so the overheads are never below the configured ones.
+ *
+ * @return the overhead, in Q16 ticks.
+ */
+static uint64_t prvWcrtOverhead( uint32_t ulCycles, uint64_t ullCyclesPerTick )
+{
+	return ( ( ( uint64_t ) ulCycles * wcrtONE ) + ullCyclesPerTick - 1U ) / ullCyclesPerTick;
+}
+
+TickType_t xWcrtGetOverhead( TickType_t xInterval, uint32_t ulDispatches, uint32_t ulPreemptions )
+{
+	uint64_t ullOverhead;
+
+	/* Also before any analysis, e.g. with precomputed tables. */
+	prvWcrtDefaultOverheads();
+
+	if( xOverheads == pdFALSE )
+	{
+		return 0U;
+	}
+
+	ullOverhead = ( ( uint64_t ) xInterval * ullTickOverhead ) + ( ( uint64_t ) ulDispatches * ullDispatchOverhead ) + ( ( uint64_t ) ulPreemptions * ullPreemptionOverhead );
+
+	return ( TickType_t ) ( ( ullOverhead + wcrtONE - 1U ) >> 16 );
+}
+
+/**
+ * Q16 utilization of a task, without dividing: *pulLo never exceeds C / T and
+ * *pulHi is never below it.
+ */
+static void prvWcrtUtilization( UBaseType_t uxIndex, uint32_t *pulLo, uint32_t *pulHi )
+{
+	const TickType_t xC = xHstTaskSet.pxWcet[ uxIndex ];
+	const uint64_t ullLo = ( ( uint64_t ) xC * xHstTaskSet.pulPeriodRecip[ uxIndex ] ) >> 16;
+
+	/* The reciprocal is at most one below ( 2^32 - 1 ) / T. */
+	const uint64_t ullHi = ullLo + 2U + ( xC >> 16 );
+
+	*pulLo = ( ullLo > 0xFFFFFFFFULL ) ? 0xFFFFFFFFUL : ( uint32_t ) ullLo;
+	*pulHi = ( ullHi > 0xFFFFFFFFULL ) ? 0xFFFFFFFFUL : ( uint32_t ) ullHi;
+}
+
+/**
+ * Hyperbolic bound, "Rate Monotonic Analysis: The Hyperbolic Bound" (Bini,
+ * Buttazzo, Buttazzo): prod( U_i + 1 ) <= 2. Only applies when the priorities
+ * are rate monotonic and no deadline is shorter than its period.
+ *
+ * @return pdTRUE if the task set is accepted.
+ */
+static BaseType_t prvWcrtHyperbolic( void )
+{
+	const TickType_t * const pxPeriod = xHstTaskSet.pxPeriod;
+	uint64_t ullProduct = wcrtONE;
+	UBaseType_t uxI;
+
+	for( uxI = 0; uxI < xHstTaskSet.uxCount; uxI++ )
+	{
+		uint32_t ulLo, ulHi;
+
+		if( ( xHstTaskSet.pxDeadline[ uxI ] < pxPeriod[ uxI ] ) || ( ( uxI > 0 ) && ( pxPeriod[ uxI ] < pxPeriod[ uxI - 1 ] ) ) )
+		{
+			return pdFALSE;
+		}
+
+		prvWcrtUtilization( uxI, &ulLo, &ulHi );
+
+		/* Rounded up, so the product is never below the real one. */
+		ullProduct = ( ( ullProduct * ( wcrtONE + ulHi ) ) + wcrtONE - 1U ) >> 16;
+
+		if( ullProduct > ( 2U * wcrtONE ) )
+		{
+			return pdFALSE;
+		}
+	}
+
+	return pdTRUE;
+}
+
+/**
+ * RTA
+ * "Improved Response-Time Analysis Calculations"
+ * http://doi.ieeecomputersociety.org/10.1109/REAL.1998.739773
+ *
+ * Arbitrary deadlines: every job q of the level-i busy period is analysed
+ * ("An Extendible Approach for Analyzing Fixed Priority Hard Real-Time Tasks",
+ * Tindell, Burns, Wellings). Job q, released at q * T, completes at the least
+ * fixed point of
+ *
+ *     w = B + ( q + 1 ) * C + sum( ceil( w / T_j ) * C_j )
+ *
+ * and its response time is w - q * T. The busy period ends with the first job
+ * that completes before the next release, so with D <= T only the first job
+ * is analysed, as before.
+ *
+ * Overheads: each job is dispatched through the HST, each higher priority job
+ * preempts the task once, and every tick runs the tick hook. They are added
+ * to w with xWcrtGetOverhead().
+ *
+ * Iterates the task set arrays: the higher priority tasks of task i are the
+ * tasks [0, i).
+ *
+ * @param uxIndex task to analyse.
+ * @param xStart a lower bound of the response time of its first job.
+ * @param pxFirstJob response time of the first job, a lower bound for the
+ * next task.
+ * @return the worst case response time, or a value above the deadline.
+ */
+static TickType_t prvWcrtExact( UBaseType_t uxIndex, TickType_t xStart, TickType_t *pxFirstJob )
+{
+	const TickType_t * const pxPeriod = xHstTaskSet.pxPeriod;
+	const uint32_t * const pulPeriodRecip = xHstTaskSet.pulPeriodRecip;
+	const TickType_t * const pxWcet = xHstTaskSet.pxWcet;
+	const TickType_t xDeadline = xHstTaskSet.pxDeadline[ uxIndex ];
+
+	TickType_t xRelease = 0U;              // Release of job q, q * T.
+	TickType_t xWork = pxWcet[ uxIndex ] + xHstTaskSet.pxBlocking[ uxIndex ];  // Own workload, B + ( q + 1 ) * C.
+	TickType_t xWcrt = 0U;
+	TickType_t xT = xStart;
+	TickType_t xW = 0U;
+	uint32_t ulJobs = 1U;                  // Own jobs, q + 1.
+	uint32_t ulPreemptions;
+
+	UBaseType_t uxJ;
+
+	*pxFirstJob = xStart;
+
+	for( ;; )
+	{
+		const TickType_t xLimit = xRelease + xDeadline;
+
+		if( xLimit < xRelease )
+		{
+			/* The busy period does not fit in a TickType_t. */
+			return portMAX_DELAY;
+		}
+
+		while( xT <= xLimit )
+		{
+			xW = xWork;
+			ulPreemptions = 0U;
+			uxIterations++;
+
+			/* Calculates the workload of the higher priority tasks. */
+			for( uxJ = 0; uxJ < uxIndex; uxJ++ )
+			{
+				const TickType_t xJobs = U_CEIL_R( xT, pxPeriod[ uxJ ], pulPeriodRecip[ uxJ ] );
+
+				xW = xW + ( xJobs * pxWcet[ uxJ ] );
+				ulPreemptions = ulPreemptions + xJobs;
+			}
+
+			if( xOverheads == pdTRUE )
+			{
+				xW = xW + xWcrtGetOverhead( xT, ulJobs + ulPreemptions, ulPreemptions );
+			}
+
+			if( xT == xW )
+			{
+				break;
+			}
+
+			xT = xW;
+		}
+
+		if( xT > xLimit )
+		{
+			/* Job q misses its deadline. */
+			return xT - xRelease;
+		}
+
+		if( ( xT - xRelease ) > xWcrt )
+		{
+			xWcrt = xT - xRelease;
+		}
+
+		if( xRelease == 0U )
+		{
+			*pxFirstJob = xT;
+		}
+
+		/* The busy period ends before the next release. */
+		if( ( xT - xRelease ) <= pxPeriod[ uxIndex ] )
+		{
+			break;
+		}
 
-		pxAppTasksListItem = listGET_NEXT( pxAppTasksListItem );
+		/* Job q + 1 completes at least C after job q. */
+		xRelease = xRelease + pxPeriod[ uxIndex ];
+		xWork = xWork + pxWcet[ uxIndex ];
+		ulJobs = ulJobs + 1U;
+		xT = xT + pxWcet[ uxIndex ];
 	}
 
-    return pdTRUE;
+	return xWcrt;
 }
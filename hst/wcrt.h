@@ -1,3 +1,131 @@
 #include "FreeRTOS.h"
 
+/* Set to 1 in scheduler_logic.h by the policies that use the response times
+ * at run time (e.g. the dual priority promotions, the slack): the exact
+ * analysis then always runs. With 0, xWcrtCalculateTasksWcrt() may store the
+ * upper bounds that proved the task set schedulable. */
+#ifndef USE_EXACT_WCRT
+	#define USE_EXACT_WCRT 0
+#endif
+
+/**
+ * Analysis layer that decided the schedulability of the task set, from the
+ * cheapest to the most expensive one.
+ */
+typedef enum
+{
+	WCRT_LAYER_NONE,         //!< Not analysed yet, or empty task set.
+	WCRT_LAYER_UTILIZATION,  //!< Rejected, total utilization above 1.
+	WCRT_LAYER_HYPERBOLIC,   //!< Accepted by the hyperbolic bound (RM, D >= T).
+	WCRT_LAYER_BOUNDS,       //!< Decided by the response time bounds of each task.
+	WCRT_LAYER_EXACT,        //!< Decided by the exact response time analysis.
+	WCRT_LAYER_OFFSETS       //!< Decided by the release offsets analysis.
+} WcrtLayer_t;
+
+#if defined (__cplusplus)
+extern "C" {
+#endif
+
+/**
+ * Schedulability analysis of the task set (xHstTaskSet), in layers:
+ *
+ * 1. Total utilization above 1: rejected.
+ * 2. Hyperbolic bound, when the priorities are rate monotonic and D >= T:
+ *    accepted.
+ * 3. For each task, the response time lower bound C / ( 1 - U ) rejects it
+ *    when above its deadline, and the Bini-Baruah upper bound accepts it when
+ *    at or below.
+ * 4. Exact response time analysis, started from the largest lower bound
+ *    (including the one of the previous task plus C). Deadlines may exceed
+ *    the periods: every job of the level-i busy period is checked.
+ * 5. With release offsets, the offset analysis of each task with D <= T,
+ *    whose response time may be below the synchronous one.
+ *
+ * The xWcrt of each task is its exact worst case response time when the
+ * exact analysis ran (always, if the policy defines USE_EXACT_WCRT as 1), or
+ * an upper bound otherwise.
+ *
+ * @return pdTRUE if the task set is schedulable.
+ */
 BaseType_t xWcrtCalculateTasksWcrt( void );
+
+/**
+ * xWcrtCalculateTasksWcrt() for the tasks [uxFrom, uxCount) only, keeping
+ * the response times of the higher priority tasks. Valid when only the tasks
+ * from uxFrom on changed since the last analysis, e.g. the wcet of task
+ * uxFrom (sensitivity.h).
+ *
+ * @param uxFrom first task to analyse.
+ * @return pdTRUE if the tasks [uxFrom, uxCount) are schedulable.
+ */
+BaseType_t xWcrtCalculateTasksWcrtFrom( UBaseType_t uxFrom );
+
+/**
+ * Audsley's optimal priority assignment for the task set (xHstTaskSet):
+ * reorders the arrays, and the uxIndex of each task, so that index 0 is the
+ * highest priority. Finds a schedulable order whenever one exists, for any
+ * deadlines, release offsets and blocking. The HstTCB_t priorities and the
+ * policy lists are not changed: vSchedulerInit() applies the order when
+ * configHST_OPTIMAL_PRIORITIES is 1. Call xWcrtCalculateTasksWcrt() next,
+ * for the response times.
+ *
+ * It only uses the task set arrays, so it also runs offline, e.g. on the
+ * host with a task set built from a list of HstTCB_t.
+ *
+ * @return pdTRUE if a schedulable order was found. Otherwise the order of
+ * the arrays is undefined.
+ */
+BaseType_t xWcrtAssignPriorities( void );
+
+/**
+ *
+ * @return the layer that decided the last xWcrtCalculateTasksWcrt() result.
+ */
+WcrtLayer_t xWcrtGetLayer( void );
+
+/**
+ *
+ * @return fixed point iterations executed by the last exact analysis.
+ */
+UBaseType_t uxWcrtGetIterations( void );
+
+/**
+ * Sets the scheduling overheads charged by xWcrtCalculateTasksWcrt(), in CPU
+ * cycles. They default to configHST_TICK_OVERHEAD_CYCLES,
+ * configHST_DISPATCH_OVERHEAD_CYCLES and configHST_PREEMPTION_OVERHEAD_CYCLES.
+ * Call xWcrtCalculateTasksWcrt() again to apply them, e.g. with the maxima
+ * measured by the benchmark.
+ *
+ * @param ulTickCycles tick interrupt and HST tick hook, each tick.
+ * @param ulDispatchCycles each job: HST activation and the context switches
+ * to and from it.
+ * @param ulPreemptionCycles each preemption: HST activation and the context
+ * switches that resume the preempted task.
+ */
+void vWcrtSetOverheads( uint32_t ulTickCycles, uint32_t ulDispatchCycles, uint32_t ulPreemptionCycles );
+
+/**
+ * Compares overheads with the configured ones, after the conversion to ticks,
+ * e.g. those a precomputed table was computed with.
+ *
+ * @param ulTickCycles as vWcrtSetOverheads().
+ * @param ulDispatchCycles as vWcrtSetOverheads().
+ * @param ulPreemptionCycles as vWcrtSetOverheads().
+ * @param ulCpuClockHz CPU clock to convert the cycles with.
+ * @return pdTRUE if the analysis charges the same overheads with them.
+ */
+BaseType_t xWcrtSameOverheads( uint32_t ulTickCycles, uint32_t ulDispatchCycles, uint32_t ulPreemptionCycles, uint32_t ulCpuClockHz );
+
+/**
+ * Overhead in an interval, rounded up to whole ticks.
+ *
+ * @param xInterval interval length, in ticks.
+ * @param ulDispatches jobs dispatched in the interval.
+ * @param ulPreemptions preemptions in the interval.
+ * @return the overhead, in ticks. 0 if no overhead is configured.
+ */
+TickType_t xWcrtGetOverhead( TickType_t xInterval, uint32_t ulDispatches, uint32_t ulPreemptions );
+
+#if defined (__cplusplus)
+}
+#endif
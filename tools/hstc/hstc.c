@@ -0,0 +1,594 @@
+/*
+ * hstc: offline task set compiler.
+ *
+ * Reads a task set description (CSV), runs the same analysis the HST runs in
+ * vSchedulerInit() for the policy it was built for (HST_SCHED), and writes a
+ * C header with the task parameters, priorities, response times, wcet
+ * headroom, promotion times (dp) and initial slacks (ss). Define
+ * configHST_TABLES_HEADER as that header, and the HST takes the results from
+ * it instead of analysing the task set at boot.
+ *
+ * The analysis code is the HST code, built for the host (see Makefile).
+ */
+
+#include "FreeRTOS.h"
+#include "list.h"
+#include "scheduler.h"
+#include "scheduler_logic.h"
+#include "taskset.h"
+#include "resource.h"
+#include "wcrt.h"
+#include "sensitivity.h"
+#include "utils.h"
+#if ( USE_QPA == 1 )
+#include "qpa.h"
+#endif
+#if ( USE_SLACK_STEALING == 1 )
+#include "slack.h"
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <unistd.h>
+
+#define hstcMAX_TASKS     ( 64 )
+#define hstcMAX_NAME      ( 32 )
+#define hstcMAX_LINE      ( 512 )
+#define hstcMAX_FIELDS    ( 2 + hstcMAX_TASKS )
+
+/* Policy flags of scheduler_logic.h, 0 when the policy does not define them. */
+#if ( USE_QPA == 1 )
+#define hstcUSE_QPA                 1
+#else
+#define hstcUSE_QPA                 0
+#endif
+#if ( USE_EXACT_WCRT == 1 )
+#define hstcUSE_EXACT_WCRT          1
+#else
+#define hstcUSE_EXACT_WCRT          0
+#endif
+#if ( USE_SLACK_STEALING == 1 )
+#define hstcUSE_SLACK_STEALING      1
+#else
+#define hstcUSE_SLACK_STEALING      0
+#endif
+
+typedef struct
+{
+	char pcName[ hstcMAX_NAME ];     /* Name in the description. */
+	char pcMacro[ hstcMAX_NAME ];    /* Name in the generated macros. */
+	HstTCB_t xTcb;
+} HstcTask_t;
+
+static void prvHstcRead( const char *pcFile );
+static BaseType_t prvHstcAnalyse( BaseType_t xOptimalPriorities );
+static void prvHstcWrite( FILE *pxOut, const char *pcInput, BaseType_t xSchedulable );
+static HstcTask_t * prvHstcFind( const char *pcName );
+static const char * prvHstcName( const HstTCB_t *pxTcb );
+static TickType_t prvHstcNumber( const char *pcField, const char *pcFile, int iLine );
+static char * prvHstcTrim( char *pcText );
+static void prvHstcUsage( void );
+
+/* CPU clock of the target, used to convert the overheads to ticks. */
+uint32_t SystemCoreClock = HSTC_CPU_CLOCK_HZ;
+
+/* Overheads of the analysis, recorded in the tables. */
+static HstTableOverheads_t xOverheads = { configHST_TICK_OVERHEAD_CYCLES, configHST_DISPATCH_OVERHEAD_CYCLES, configHST_PREEMPTION_OVERHEAD_CYCLES, 0U };
+
+/* Task set, in description order, and the list the task set is built from. */
+static HstcTask_t xTasks[ hstcMAX_TASKS ];
+static UBaseType_t uxTasks = 0;
+static List_t xTasksList;
+List_t * pxAllTasksList = &xTasksList;
+
+int main( int argc, char **argv )
+{
+	BaseType_t xOptimalPriorities = pdFALSE;
+	BaseType_t xSchedulable;
+	FILE *pxOut = stdout;
+	int iOption;
+
+	while( ( iOption = getopt( argc, argv, "pc:O:" ) ) != -1 )
+	{
+		switch( iOption )
+		{
+			case 'p':
+				xOptimalPriorities = pdTRUE;
+				break;
+
+			case 'c':
+				SystemCoreClock = ( uint32_t ) strtoul( optarg, NULL, 10 );
+				break;
+
+			case 'O':
+			{
+				unsigned long ulTick, ulDispatch, ulPreemption;
+
+				if( sscanf( optarg, "%lu,%lu,%lu", &ulTick, &ulDispatch, &ulPreemption ) != 3 )
+				{
+					prvHstcUsage();
+				}
+
+				xOverheads.ulTickCycles = ( uint32_t ) ulTick;
+				xOverheads.ulDispatchCycles = ( uint32_t ) ulDispatch;
+				xOverheads.ulPreemptionCycles = ( uint32_t ) ulPreemption;
+				break;
+			}
+
+			default:
+				prvHstcUsage();
+		}
+	}
+
+	if( ( optind >= argc ) || ( ( argc - optind ) > 2 ) || ( SystemCoreClock < configTICK_RATE_HZ ) )
+	{
+		prvHstcUsage();
+	}
+
+	/* After -c, the clock the cycles are converted with. */
+	vWcrtSetOverheads( xOverheads.ulTickCycles, xOverheads.ulDispatchCycles, xOverheads.ulPreemptionCycles );
+
+	if( ( xOverheads.ulTickCycles | xOverheads.ulDispatchCycles | xOverheads.ulPreemptionCycles ) != 0U )
+	{
+		xOverheads.ulCpuClockHz = SystemCoreClock;
+	}
+
+	prvHstcRead( argv[ optind ] );
+
+	xSchedulable = prvHstcAnalyse( xOptimalPriorities );
+
+	if( ( argc - optind ) == 2 )
+	{
+		pxOut = fopen( argv[ optind + 1 ], "w" );
+
+		if( pxOut == NULL )
+		{
+			perror( argv[ optind + 1 ] );
+			return 1;
+		}
+	}
+
+	prvHstcWrite( pxOut, argv[ optind ], xSchedulable );
+
+	if( pxOut != stdout )
+	{
+		fclose( pxOut );
+	}
+
+	if( xSchedulable == pdFALSE )
+	{
+		fprintf( stderr, "hstc: %s: the task set is not schedulable under %s\n", argv[ optind ], HSTC_SCHED );
+		return 2;
+	}
+
+	return 0;
+}
+
+/**
+ * One task or resource per line, fields separated by commas, '#' starts a
+ * comment:
+ *
+ *     name, period, deadline, wcet[, offset]
+ *     resource, name, task:cs[, task:cs ...]
+ *
+ * Tasks are listed by decreasing priority, and declared before the resources
+ * that name them.
+ */
+static void prvHstcRead( const char *pcFile )
+{
+	FILE *pxIn = fopen( pcFile, "r" );
+	char pcLine[ hstcMAX_LINE ];
+	int iLine = 0;
+
+	if( pxIn == NULL )
+	{
+		perror( pcFile );
+		exit( 1 );
+	}
+
+	vListInitialise( &xTasksList );
+
+	while( fgets( pcLine, sizeof( pcLine ), pxIn ) != NULL )
+	{
+		char *pcFields[ hstcMAX_FIELDS ];
+		char *pcComment = strchr( pcLine, '#' );
+		char *pcNext = pcLine;
+		int iFields = 0;
+
+		iLine++;
+
+		if( pcComment != NULL )
+		{
+			*pcComment = '\0';
+		}
+
+		if( *prvHstcTrim( pcLine ) == '\0' )
+		{
+			continue;
+		}
+
+		while( ( pcNext != NULL ) && ( iFields < hstcMAX_FIELDS ) )
+		{
+			char *pcComma = strchr( pcNext, ',' );
+
+			if( pcComma != NULL )
+			{
+				*pcComma = '\0';
+			}
+
+			pcFields[ iFields++ ] = prvHstcTrim( pcNext );
+			pcNext = ( pcComma != NULL ) ? pcComma + 1 : NULL;
+		}
+
+		if( strcmp( pcFields[ 0 ], "resource" ) == 0 )
+		{
+			HstResource_t *pxResource = pxResourceCreate();
+			int iField;
+
+			if( iFields < 3 )
+			{
+				fprintf( stderr, "%s:%d: a resource needs a name and at least one user\n", pcFile, iLine );
+				exit( 1 );
+			}
+
+			for( iField = 2; iField < iFields; iField++ )
+			{
+				char *pcCs = strchr( pcFields[ iField ], ':' );
+				HstcTask_t *pxTask;
+
+				if( pcCs == NULL )
+				{
+					fprintf( stderr, "%s:%d: expected task:cs, got '%s'\n", pcFile, iLine, pcFields[ iField ] );
+					exit( 1 );
+				}
+
+				*pcCs = '\0';
+				pxTask = prvHstcFind( prvHstcTrim( pcFields[ iField ] ) );
+
+				if( pxTask == NULL )
+				{
+					fprintf( stderr, "%s:%d: unknown task '%s'\n", pcFile, iLine, pcFields[ iField ] );
+					exit( 1 );
+				}
+
+				xResourceUse( pxResource, &( pxTask->xTcb ), prvHstcNumber( prvHstcTrim( pcCs + 1 ), pcFile, iLine ) );
+			}
+		}
+		else
+		{
+			HstcTask_t *pxTask = &( xTasks[ uxTasks ] );
+			HstTCB_t *pxTcb = &( pxTask->xTcb );
+			UBaseType_t uxI;
+			char *pcMacro;
+
+			if( ( iFields < 4 ) || ( iFields > 5 ) )
+			{
+				fprintf( stderr, "%s:%d: expected name, period, deadline, wcet[, offset]\n", pcFile, iLine );
+				exit( 1 );
+			}
+
+			if( ( uxTasks == hstcMAX_TASKS ) || ( strlen( pcFields[ 0 ] ) >= hstcMAX_NAME ) || ( prvHstcFind( pcFields[ 0 ] ) != NULL ) )
+			{
+				fprintf( stderr, "%s:%d: too many tasks, or a long or repeated name\n", pcFile, iLine );
+				exit( 1 );
+			}
+
+			strcpy( pxTask->pcName, pcFields[ 0 ] );
+
+			for( pcMacro = strcpy( pxTask->pcMacro, pcFields[ 0 ] ); *pcMacro != '\0'; pcMacro++ )
+			{
+				*pcMacro = isalnum( ( unsigned char ) *pcMacro ) ? ( char ) toupper( ( unsigned char ) *pcMacro ) : '_';
+			}
+
+			for( uxI = 0; uxI < uxTasks; uxI++ )
+			{
+				if( strcmp( xTasks[ uxI ].pcMacro, pxTask->pcMacro ) == 0 )
+				{
+					fprintf( stderr, "%s:%d: '%s' and '%s' give the same macro names\n", pcFile, iLine, xTasks[ uxI ].pcName, pxTask->pcName );
+					exit( 1 );
+				}
+			}
+
+			/* As xSchedulerTaskCreateWithOffset(), with the description order
+			 * as the priority. */
+			memset( pxTcb, 0, sizeof( HstTCB_t ) );
+			pxTcb->xPriority = uxTasks;
+			pxTcb->xPeriod = prvHstcNumber( pcFields[ 1 ], pcFile, iLine );
+			pxTcb->xDeadline = prvHstcNumber( pcFields[ 2 ], pcFile, iLine );
+			pxTcb->xWcet = prvHstcNumber( pcFields[ 3 ], pcFile, iLine );
+			pxTcb->xOffset = ( iFields == 5 ) ? prvHstcNumber( pcFields[ 4 ], pcFile, iLine ) : 0U;
+			pxTcb->xRelease = pxTcb->xOffset;
+			pxTcb->xAbsoluteDeadline = pxTcb->xOffset + pxTcb->xDeadline;
+			pxTcb->xHstTaskType = HST_PERIODIC;
+			pxTcb->xState = HST_READY;
+
+			if( ( pxTcb->xPeriod == 0U ) || ( pxTcb->xDeadline == 0U ) )
+			{
+				fprintf( stderr, "%s:%d: the period and deadline must be positive\n", pcFile, iLine );
+				exit( 1 );
+			}
+
+			pxTcb->ulPeriodRecip = ulUtilsReciprocal( pxTcb->xPeriod );
+
+			/* Ordered as the policy orders pxAllTasksList. */
+			vListInitialiseItem( &( pxTcb->xGenericListItem ) );
+			listSET_LIST_ITEM_OWNER( &( pxTcb->xGenericListItem ), pxTcb );
+#if ( USE_QPA == 1 )
+			listSET_LIST_ITEM_VALUE( &( pxTcb->xGenericListItem ), pxTcb->xDeadline );
+#else
+			listSET_LIST_ITEM_VALUE( &( pxTcb->xGenericListItem ), pxTcb->xPriority );
+#endif
+			vListInsert( &xTasksList, &( pxTcb->xGenericListItem ) );
+
+			uxTasks++;
+		}
+	}
+
+	fclose( pxIn );
+}
+
+/**
+ * The steps of vSchedulerInit() and of the policy start logic, in the same
+ * order.
+ */
+static BaseType_t prvHstcAnalyse( BaseType_t xOptimalPriorities )
+{
+	BaseType_t xSchedulable;
+	UBaseType_t uxI;
+
+	if( xTaskSetBuild( &xTasksList ) == pdFAIL )
+	{
+		fprintf( stderr, "hstc: out of memory\n" );
+		exit( 1 );
+	}
+
+	if( xOptimalPriorities == pdTRUE )
+	{
+#if ( USE_QPA == 1 )
+		fprintf( stderr, "hstc: -p ignored, %s does not use priorities\n", HSTC_SCHED );
+#else
+		if( xWcrtAssignPriorities() == pdTRUE )
+		{
+			for( uxI = 0; uxI < xHstTaskSet.uxCount; uxI++ )
+			{
+				xHstTaskSet.pxTask[ uxI ]->xPriority = uxI;
+			}
+		}
+		else
+		{
+			fprintf( stderr, "hstc: no priority order is schedulable, keeping the description order\n" );
+			xTaskSetBuild( &xTasksList );
+		}
+#endif
+	}
+
+	vResourceSetup();
+
+	/* Runs the policy test, and the sensitivity analysis. */
+	xSchedulable = xSensitivityAnalyse();
+
+#if ( USE_SLACK_STEALING == 1 )
+	{
+		static TaskSs_t xSlack[ hstcMAX_TASKS ];
+
+		for( uxI = 0; uxI < xHstTaskSet.uxCount; uxI++ )
+		{
+			xHstTaskSet.pxTask[ uxI ]->vExt = &( xSlack[ uxI ] );
+			vSlackCalculateSlack_fixed1( xHstTaskSet.pxTask[ uxI ], 0 );
+		}
+
+		/* Report the cost of the table, to choose SLACK_TABLE. */
+		if( xSlackBuildTable() == pdTRUE )
+		{
+			fprintf( stderr, "hstc: slack table over the hyperperiod: %lu bytes\n", ( unsigned long ) xSlackGetTableSize() );
+		}
+		else
+		{
+			fprintf( stderr, "hstc: no slack table, the hyperperiod or the slack differences are too large\n" );
+		}
+	}
+#else
+	( void ) uxI;
+#endif
+
+	return xSchedulable;
+}
+
+static void prvHstcWrite( FILE *pxOut, const char *pcInput, BaseType_t xSchedulable )
+{
+	const uint32_t ulScaling = ulSensitivityGetScaling();
+	/* Q16 to thousandths, rounded to the nearest. */
+	const unsigned long ulMilli = ( unsigned long ) ( ( ( uint64_t ) ulScaling * 1000U + 0x8000U ) >> 16 );
+	UBaseType_t uxI;
+
+	fprintf( pxOut, "/*\n" );
+	fprintf( pxOut, " * Generated by hstc (HST_SCHED = %s) from %s. Do not edit: change the\n", HSTC_SCHED, pcInput );
+	fprintf( pxOut, " * task set description and run hstc again.\n" );
+	fprintf( pxOut, " *\n" );
+	fprintf( pxOut, " * Schedulable: %s. Critical scaling factor: %lu.%03lu.\n", ( xSchedulable == pdTRUE ) ? "yes" : "no",
+			 ulMilli / 1000UL, ulMilli % 1000UL );
+	fprintf( pxOut, " */\n\n" );
+
+	fprintf( pxOut, "/* Policy the tables were computed for (checked by scheduler.c). */\n" );
+	fprintf( pxOut, "#define HST_TABLE_USE_QPA                %d\n", hstcUSE_QPA );
+	fprintf( pxOut, "#define HST_TABLE_USE_EXACT_WCRT         %d\n", hstcUSE_EXACT_WCRT );
+	fprintf( pxOut, "#define HST_TABLE_USE_SLACK_STEALING     %d\n\n", hstcUSE_SLACK_STEALING );
+
+	fprintf( pxOut, "/* Overheads of the analysis, in CPU cycles (vWcrtSetOverheads()). */\n" );
+	fprintf( pxOut, "#define HST_TABLE_TICK_OVERHEAD_CYCLES       %lu\n", ( unsigned long ) xOverheads.ulTickCycles );
+	fprintf( pxOut, "#define HST_TABLE_DISPATCH_OVERHEAD_CYCLES   %lu\n", ( unsigned long ) xOverheads.ulDispatchCycles );
+	fprintf( pxOut, "#define HST_TABLE_PREEMPTION_OVERHEAD_CYCLES %lu\n", ( unsigned long ) xOverheads.ulPreemptionCycles );
+	fprintf( pxOut, "#define HST_TABLE_CPU_CLOCK_HZ               %lu\n\n", ( unsigned long ) xOverheads.ulCpuClockHz );
+
+	fprintf( pxOut, "/* Periodic tasks and analysis result. */\n" );
+	fprintf( pxOut, "#define HST_TABLE_TASKS                  %lu\n", ( unsigned long ) xHstTaskSet.uxCount );
+	fprintf( pxOut, "#define HST_TABLE_SCHEDULABLE            %d\n", ( xSchedulable == pdTRUE ) ? 1 : 0 );
+	fprintf( pxOut, "#define HST_TABLE_SCALING                0x%08lxUL  /* Q16 */\n", ( unsigned long ) ulScaling );
+
+#if ( USE_SLACK_STEALING == 1 )
+	/* Memory for the slack table of SLACK_TABLE (slack.h), 0 if it can
+	 * not be built. */
+	fprintf( pxOut, "#define HST_TABLE_SLACK_TABLE_BYTES      %lu\n", ( unsigned long ) xSlackGetTableSize() );
+#endif
+
+	/* Creation parameters and results of each task, by name. */
+	for( uxI = 0; uxI < uxTasks; uxI++ )
+	{
+		const HstcTask_t *pxTask = &( xTasks[ uxI ] );
+		const HstTCB_t *pxTcb = &( pxTask->xTcb );
+		const char *pcMacro = pxTask->pcMacro;
+
+		fprintf( pxOut, "\n/* %s */\n", pxTask->pcName );
+		fprintf( pxOut, "#define HST_%s_PRIORITY\t%lu\n", pcMacro, ( unsigned long ) pxTcb->xPriority );
+		fprintf( pxOut, "#define HST_%s_PERIOD\t%lu\n", pcMacro, ( unsigned long ) pxTcb->xPeriod );
+		fprintf( pxOut, "#define HST_%s_DEADLINE\t%lu\n", pcMacro, ( unsigned long ) pxTcb->xDeadline );
+		fprintf( pxOut, "#define HST_%s_WCET\t%lu\n", pcMacro, ( unsigned long ) pxTcb->xWcet );
+		fprintf( pxOut, "#define HST_%s_OFFSET\t%lu\n", pcMacro, ( unsigned long ) pxTcb->xOffset );
+		fprintf( pxOut, "#define HST_%s_WCRT\t%lu\n", pcMacro, ( unsigned long ) pxTcb->xWcrt );
+		fprintf( pxOut, "#define HST_%s_WCET_MAX\t%lu\n", pcMacro, ( unsigned long ) pxTcb->xWcetMax );
+
+		if( strcmp( HSTC_SCHED, "dp" ) == 0 )
+		{
+			/* As vSchedulerTaskSchedulerStartLogic() of the dp policy. */
+			fprintf( pxOut, "#define HST_%s_PROMOTION\t%ld\n", pcMacro, ( long ) ( ( BaseType_t ) pxTcb->xDeadline - ( BaseType_t ) pxTcb->xWcrt ) );
+		}
+
+#if ( USE_SLACK_STEALING == 1 )
+		fprintf( pxOut, "#define HST_%s_SLACK\t%ld\n", pcMacro, ( long ) xHstTaskSet.pxSlack[ pxTcb->uxIndex ] );
+#endif
+	}
+
+	fprintf( pxOut, "\n#ifdef HST_TABLES_DEFINE\n" );
+	fprintf( pxOut, "/* Overheads the tables were computed with. */\n" );
+	fprintf( pxOut, "static const HstTableOverheads_t xHstTableOverheads =\n{\n" );
+	fprintf( pxOut, "\tHST_TABLE_TICK_OVERHEAD_CYCLES, HST_TABLE_DISPATCH_OVERHEAD_CYCLES, HST_TABLE_PREEMPTION_OVERHEAD_CYCLES, HST_TABLE_CPU_CLOCK_HZ\n};\n\n" );
+	fprintf( pxOut, "/* Precomputed analysis, in task set order (taskset.h). */\n" );
+	fprintf( pxOut, "static const HstTableEntry_t xHstTable[ HST_TABLE_TASKS ] =\n{\n" );
+	fprintf( pxOut, "\t/* xPeriod, xDeadline, xWcet, xOffset, xBlocking, xWcrt, xWcetMax, xSlack, xTtma */\n" );
+
+	for( uxI = 0; uxI < xHstTaskSet.uxCount; uxI++ )
+	{
+		const HstTCB_t *pxTcb = xHstTaskSet.pxTask[ uxI ];
+		BaseType_t xSlack = 0;
+		TickType_t xTtma = 0U;
+
+#if ( USE_SLACK_STEALING == 1 )
+		xSlack = xHstTaskSet.pxSlack[ uxI ];
+		xTtma = ( ( const TaskSs_t * ) pxTcb->vExt )->xTtma;
+#endif
+
+		fprintf( pxOut, "\t{ %lu, %lu, %lu, %lu, %lu, %lu, %lu, %ld, %lu },  /* %s */\n",
+				 ( unsigned long ) pxTcb->xPeriod, ( unsigned long ) pxTcb->xDeadline, ( unsigned long ) pxTcb->xWcet,
+				 ( unsigned long ) pxTcb->xOffset, ( unsigned long ) xHstTaskSet.pxBlocking[ uxI ], ( unsigned long ) pxTcb->xWcrt,
+				 ( unsigned long ) pxTcb->xWcetMax, ( long ) xSlack, ( unsigned long ) xTtma, prvHstcName( pxTcb ) );
+	}
+
+	fprintf( pxOut, "};\n#endif\n" );
+}
+
+static HstcTask_t * prvHstcFind( const char *pcName )
+{
+	UBaseType_t uxI;
+
+	for( uxI = 0; uxI < uxTasks; uxI++ )
+	{
+		if( strcmp( xTasks[ uxI ].pcName, pcName ) == 0 )
+		{
+			return &( xTasks[ uxI ] );
+		}
+	}
+
+	return NULL;
+}
+
+static const char * prvHstcName( const HstTCB_t *pxTcb )
+{
+	UBaseType_t uxI;
+
+	for( uxI = 0; uxI < uxTasks; uxI++ )
+	{
+		if( &( xTasks[ uxI ].xTcb ) == pxTcb )
+		{
+			break;
+		}
+	}
+
+	return xTasks[ uxI ].pcName;
+}
+
+static TickType_t prvHstcNumber( const char *pcField, const char *pcFile, int iLine )
+{
+	char *pcEnd;
+	const unsigned long ulValue = strtoul( pcField, &pcEnd, 0 );
+
+	if( ( *pcField == '\0' ) || ( *pcEnd != '\0' ) || ( ulValue >= portMAX_DELAY ) )
+	{
+		fprintf( stderr, "%s:%d: '%s' is not a tick count\n", pcFile, iLine, pcField );
+		exit( 1 );
+	}
+
+	return ( TickType_t ) ulValue;
+}
+
+static char * prvHstcTrim( char *pcText )
+{
+	char *pcEnd;
+
+	while( isspace( ( unsigned char ) *pcText ) )
+	{
+		pcText++;
+	}
+
+	pcEnd = pcText + strlen( pcText );
+
+	while( ( pcEnd > pcText ) && isspace( ( unsigned char ) pcEnd[ -1 ] ) )
+	{
+		*--pcEnd = '\0';
+	}
+
+	return pcText;
+}
+
+static void prvHstcUsage( void )
+{
+	fprintf( stderr, "usage: hstc [-p] [-c cpu_hz] [-O tick,dispatch,preemption] tasks.csv [tables.h]\n" );
+	fprintf( stderr, "  -p  Audsley's optimal priority assignment (fixed priority policies)\n" );
+	fprintf( stderr, "  -c  CPU clock of the target, to convert the overheads (default %lu)\n", ( unsigned long ) HSTC_CPU_CLOCK_HZ );
+	fprintf( stderr, "  -O  scheduling overheads, in CPU cycles (see vWcrtSetOverheads())\n" );
+	exit( 1 );
+}
+
+/* --- Kernel functions referenced by the HST objects, never called offline. */
+
+void *pvPortMalloc( size_t xWantedSize )
+{
+	return malloc( xWantedSize );
+}
+
+void vPortFree( void *pv )
+{
+	free( pv );
+}
+
+void vTaskSuspendAll( void )
+{
+}
+
+BaseType_t xTaskResumeAll( void )
+{
+	return pdFALSE;
+}
+
+void *pvTaskGetThreadLocalStoragePointer( TaskHandle_t xTaskToQuery, BaseType_t xIndex )
+{
+	( void ) xTaskToQuery;
+	( void ) xIndex;
+
+	return NULL;
+}
+
+void vSchedulerWakeUp( void )
+{
+}
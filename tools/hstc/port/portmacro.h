@@ -0,0 +1,55 @@
+/*
+ * Host port for the task set compiler: the types of the Cortex-M ports, so
+ * the analysis computes with the same widths as on the target, and no
+ * interrupts or scheduler. Only the HST analysis and list.c are built with it.
+ */
+
+#ifndef PORTMACRO_H
+#define PORTMACRO_H
+
+#include <stdint.h>
+#include <stdlib.h>
+
+#define portCHAR		char
+#define portFLOAT		float
+#define portDOUBLE		double
+#define portLONG		int32_t
+#define portSHORT		short
+#define portSTACK_TYPE	uint32_t
+#define portBASE_TYPE	int32_t
+
+typedef portSTACK_TYPE StackType_t;
+typedef int32_t BaseType_t;
+typedef uint32_t UBaseType_t;
+
+#if( configUSE_16_BIT_TICKS == 1 )
+	typedef uint16_t TickType_t;
+	#define portMAX_DELAY ( TickType_t ) 0xffff
+#else
+	typedef uint32_t TickType_t;
+	#define portMAX_DELAY ( TickType_t ) 0xffffffffUL
+#endif
+
+#define portSTACK_GROWTH			( -1 )
+#define portTICK_PERIOD_MS			( ( TickType_t ) 1000 / configTICK_RATE_HZ )
+#define portBYTE_ALIGNMENT			8
+
+/* A failed configASSERT() disables the interrupts: stop the tool. */
+#define portDISABLE_INTERRUPTS()				abort()
+#define portENABLE_INTERRUPTS()
+#define portSET_INTERRUPT_MASK_FROM_ISR()		0
+#define portCLEAR_INTERRUPT_MASK_FROM_ISR( x )	( void ) ( x )
+#define portENTER_CRITICAL()
+#define portEXIT_CRITICAL()
+#define portYIELD()
+#define portEND_SWITCHING_ISR( xSwitchRequired )
+#define portYIELD_FROM_ISR( x )
+
+#define portTASK_FUNCTION_PROTO( vFunction, pvParameters ) void vFunction( void *pvParameters )
+#define portTASK_FUNCTION( vFunction, pvParameters ) void vFunction( void *pvParameters )
+
+#define portNOP()
+#define portINLINE	__inline
+#define portFORCE_INLINE inline __attribute__(( always_inline))
+
+#endif /* PORTMACRO_H */